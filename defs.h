@@ -19,6 +19,9 @@
 // Define the size of a 64-bit unsigned integer
 #define U64 unsigned long long
 
+// Define the size of a 16-bit unsigned integer
+#define U16 unsigned short
+
 // FEN debug positions for testing
 #define empty_board "8/8/8/8/8/8/8/8 b - - "
 #define start_position "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 "
@@ -105,9 +108,19 @@ extern U64 side_key;
 extern void init_random_keys();
 extern U64 generate_hash_key();
 
-// Move list structure
+// Cuckoo tables of reversible moves for upcoming repetition detection
+#define cuckoo_size 8192
+#define cuckoo_h1(key) ((int)((key) & 0x1fff))
+#define cuckoo_h2(key) ((int)(((key) >> 16) & 0x1fff))
+
+extern U64 cuckoo_keys[cuckoo_size];
+extern U16 cuckoo_moves[cuckoo_size];
+
+extern void init_cuckoo();
+
+// Move list structure (compact 16-bit moves)
 typedef struct {
-    int moves[256];
+    U16 moves[256];
     int count;
 } moves;
 
@@ -3,7 +3,7 @@
 #include "perft.h"
 #include <unordered_map>
 #include "search.h"
-#include "tt.h"
+#include "tt_new.h"
 #include "magic.h"
 #include "evaluation.h"
 
@@ -183,4 +183,5 @@ void init_bitboards()
     init_sliders_attacks(bishop);
     init_sliders_attacks(rook);
     init_random_keys();
+    init_cuckoo();
 }
@@ -5,9 +5,9 @@
 
 #include "defs.h"
 #include "io.h"
-#include "tt.h"
+#include "tt_new.h"
 #include "uci.h"
-#include "threads.h"
+#include "threads_new.h"
 
 int main()
 {
@@ -53,6 +53,17 @@ void communicate() {
     read_input();
 }
 
+// open a file, NULL on failure (fopen_s is MSVC only)
+FILE* open_stream(const char* path, const char* mode)
+{
+#ifdef _WIN32
+    FILE* file = NULL;
+    return (fopen_s(&file, path, mode) == 0) ? file : NULL;
+#else
+    return fopen(path, mode);
+#endif
+}
+
 // count bits within a bitboard (Brian Kernighan's way)
 int count_bits(U64 bitboard)
 {
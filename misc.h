@@ -1,12 +1,14 @@
 #pragma once
-#ifndef MISC_H
-#define MISC_H
+#ifndef ENGINE_MISC_H
+#define ENGINE_MISC_H
 
 #include "defs.h"
+#include <stdio.h>
 
 extern int get_time_ms();
 extern int input_waiting();
 extern void read_input();
 extern void communicate();
+extern FILE* open_stream(const char* path, const char* mode);
 
 #endif
@@ -82,9 +82,9 @@ void print_move_list(moves* move_list)
             square_to_coordinates[get_move_source(move)],
             square_to_coordinates[get_move_target(move)],
             get_move_promoted(move) ? mapPieceToPromotion(get_move_promoted(move)) : ' ',
-            ascii_pieces[get_move_piece(move)],
-            get_move_capture(move) ? 1 : 0,
-            get_move_double(move) ? 1 : 0,
+            ascii_pieces[get_move_piece(bitboards, side, move)],
+            get_move_capture(occupancies, side, move) ? 1 : 0,
+            get_move_double(get_move_piece(bitboards, side, move), move) ? 1 : 0,
             get_move_enpassant(move) ? 1 : 0,
             get_move_castling(move) ? 1 : 0);
     }
@@ -100,10 +100,10 @@ int make_move(int move, int move_flag)
 
         int source_square = get_move_source(move);
         int target_square = get_move_target(move);
-        int piece = get_move_piece(move);
+        int piece = get_move_piece(bitboards, side, move);
         int promoted_piece = get_move_promoted(move);
-        int capture = get_move_capture(move);
-        int double_push = get_move_double(move);
+        int capture = get_move_capture(occupancies, side, move);
+        int double_push = get_move_double(piece, move);
         int enpass = get_move_enpassant(move);
         int castling = get_move_castling(move);
 
@@ -150,6 +150,8 @@ int make_move(int move, int move_flag)
                 hash_key ^= piece_keys[p][target_square];
             }
 
+            if (side == black) promoted_piece += p;
+
             set_bit(bitboards[promoted_piece], target_square);
             hash_key ^= piece_keys[promoted_piece][target_square];
         }
@@ -244,7 +246,7 @@ int make_move(int move, int move_flag)
     }
     else
     {
-        if (get_move_capture(move))
+        if (get_move_capture(occupancies, side, move))
             return make_move(move, all_moves);
         else
             return 0;
@@ -255,292 +257,11 @@ int make_move(int move, int move_flag)
 void generate_moves(moves* move_list)
 {
     move_list->count = 0;
-    int source_square, target_square;
-    U64 bitboard, attacks;
-
-    for (int piece = P; piece <= k; piece++)
-    {
-        bitboard = bitboards[piece];
-
-        if (side == white)
-        {
-            if (piece == P)
-            {
-                while (bitboard)
-                {
-                    source_square = get_ls1b_index(bitboard);
-                    target_square = source_square - 8;
-
-                    if (!(target_square < a8) && !get_bit(occupancies[both], target_square))
-                    {
-                        if (source_square >= a7 && source_square <= h7)
-                        {
-                            add_move(move_list, encode_move(source_square, target_square, piece, Q, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, R, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, B, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, N, 0, 0, 0, 0));
-                        }
-                        else
-                        {
-                            add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                            if ((source_square >= a2 && source_square <= h2) && !get_bit(occupancies[both], target_square - 8))
-                                add_move(move_list, encode_move(source_square, target_square - 8, piece, 0, 0, 1, 0, 0));
-                        }
-                    }
-
-                    attacks = pawn_attacks[side][source_square] & occupancies[black];
-
-                    while (attacks)
-                    {
-                        target_square = get_ls1b_index(attacks);
-
-                        if (source_square >= a7 && source_square <= h7)
-                        {
-                            add_move(move_list, encode_move(source_square, target_square, piece, Q, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, R, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, B, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, N, 1, 0, 0, 0));
-                        }
-                        else
-                            add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-
-                        pop_bit(attacks, target_square);
-                    }
-
-                    if (enpassant != no_sq)
-                    {
-                        U64 enpassant_attacks = pawn_attacks[side][source_square] & (1ULL << enpassant);
-                        if (enpassant_attacks)
-                        {
-                            int target_enpassant = get_ls1b_index(enpassant_attacks);
-                            add_move(move_list, encode_move(source_square, target_enpassant, piece, 0, 1, 0, 1, 0));
-                        }
-                    }
-
-                    pop_bit(bitboard, source_square);
-                }
-            }
 
-            if (piece == K)
-            {
-                if (castle & wk)
-                {
-                    if (!get_bit(occupancies[both], f1) && !get_bit(occupancies[both], g1))
-                    {
-                        if (!is_square_attacked(e1, black) && !is_square_attacked(f1, black))
-                            add_move(move_list, encode_move(e1, g1, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-
-                if (castle & wq)
-                {
-                    if (!get_bit(occupancies[both], d1) && !get_bit(occupancies[both], c1) && !get_bit(occupancies[both], b1))
-                    {
-                        if (!is_square_attacked(e1, black) && !is_square_attacked(d1, black))
-                            add_move(move_list, encode_move(e1, c1, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-            }
-        }
-        else
-        {
-            if (piece == p)
-            {
-                while (bitboard)
-                {
-                    source_square = get_ls1b_index(bitboard);
-                    target_square = source_square + 8;
-
-                    if (!(target_square > h1) && !get_bit(occupancies[both], target_square))
-                    {
-                        if (source_square >= a2 && source_square <= h2)
-                        {
-                            add_move(move_list, encode_move(source_square, target_square, piece, q, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, r, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, b, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, n, 0, 0, 0, 0));
-                        }
-                        else
-                        {
-                            add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                            if ((source_square >= a7 && source_square <= h7) && !get_bit(occupancies[both], target_square + 8))
-                                add_move(move_list, encode_move(source_square, target_square + 8, piece, 0, 0, 1, 0, 0));
-                        }
-                    }
-
-                    attacks = pawn_attacks[side][source_square] & occupancies[white];
-
-                    while (attacks)
-                    {
-                        target_square = get_ls1b_index(attacks);
-
-                        if (source_square >= a2 && source_square <= h2)
-                        {
-                            add_move(move_list, encode_move(source_square, target_square, piece, q, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, r, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, b, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, n, 1, 0, 0, 0));
-                        }
-                        else
-                            add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-
-                        pop_bit(attacks, target_square);
-                    }
-
-                    if (enpassant != no_sq)
-                    {
-                        U64 enpassant_attacks = pawn_attacks[side][source_square] & (1ULL << enpassant);
-                        if (enpassant_attacks)
-                        {
-                            int target_enpassant = get_ls1b_index(enpassant_attacks);
-                            add_move(move_list, encode_move(source_square, target_enpassant, piece, 0, 1, 0, 1, 0));
-                        }
-                    }
-
-                    pop_bit(bitboard, source_square);
-                }
-            }
-
-            if (piece == k)
-            {
-                if (castle & bk)
-                {
-                    if (!get_bit(occupancies[both], f8) && !get_bit(occupancies[both], g8))
-                    {
-                        if (!is_square_attacked(e8, white) && !is_square_attacked(f8, white))
-                            add_move(move_list, encode_move(e8, g8, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-
-                if (castle & bq)
-                {
-                    if (!get_bit(occupancies[both], d8) && !get_bit(occupancies[both], c8) && !get_bit(occupancies[both], b8))
-                    {
-                        if (!is_square_attacked(e8, white) && !is_square_attacked(d8, white))
-                            add_move(move_list, encode_move(e8, c8, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-            }
-        }
-
-        // Knight moves
-        if ((side == white) ? piece == N : piece == n)
-        {
-            while (bitboard)
-            {
-                source_square = get_ls1b_index(bitboard);
-                attacks = knight_attacks[source_square] & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-
-                while (attacks)
-                {
-                    target_square = get_ls1b_index(attacks);
-
-                    if (!get_bit(((side == white) ? occupancies[black] : occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-
-                    pop_bit(attacks, target_square);
-                }
-
-                pop_bit(bitboard, source_square);
-            }
-        }
-
-        // Bishop moves
-        if ((side == white) ? piece == B : piece == b)
-        {
-            while (bitboard)
-            {
-                source_square = get_ls1b_index(bitboard);
-                attacks = get_bishop_attacks(source_square, occupancies[both]) & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-
-                while (attacks)
-                {
-                    target_square = get_ls1b_index(attacks);
-
-                    if (!get_bit(((side == white) ? occupancies[black] : occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-
-                    pop_bit(attacks, target_square);
-                }
-
-                pop_bit(bitboard, source_square);
-            }
-        }
-
-        // Rook moves
-        if ((side == white) ? piece == R : piece == r)
-        {
-            while (bitboard)
-            {
-                source_square = get_ls1b_index(bitboard);
-                attacks = get_rook_attacks(source_square, occupancies[both]) & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-
-                while (attacks)
-                {
-                    target_square = get_ls1b_index(attacks);
-
-                    if (!get_bit(((side == white) ? occupancies[black] : occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-
-                    pop_bit(attacks, target_square);
-                }
-
-                pop_bit(bitboard, source_square);
-            }
-        }
-
-        // Queen moves
-        if ((side == white) ? piece == Q : piece == q)
-        {
-            while (bitboard)
-            {
-                source_square = get_ls1b_index(bitboard);
-                attacks = get_queen_attacks(source_square, occupancies[both]) & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-
-                while (attacks)
-                {
-                    target_square = get_ls1b_index(attacks);
-
-                    if (!get_bit(((side == white) ? occupancies[black] : occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-
-                    pop_bit(attacks, target_square);
-                }
-
-                pop_bit(bitboard, source_square);
-            }
-        }
-
-        // King moves
-        if ((side == white) ? piece == K : piece == k)
-        {
-            while (bitboard)
-            {
-                source_square = get_ls1b_index(bitboard);
-                attacks = king_attacks[source_square] & ((side == white) ? ~occupancies[white] : ~occupancies[black]);
-
-                while (attacks)
-                {
-                    target_square = get_ls1b_index(attacks);
-
-                    if (!get_bit(((side == white) ? occupancies[black] : occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-
-                    pop_bit(attacks, target_square);
-                }
-
-                pop_bit(bitboard, source_square);
-            }
-        }
-    }
+    if (side == white)
+        generate<white, gen_all>(bitboards, occupancies, enpassant, castle, 0ULL, move_list,
+            [](int square) { return is_square_attacked(square, black); });
+    else
+        generate<black, gen_all>(bitboards, occupancies, enpassant, castle, 0ULL, move_list,
+            [](int square) { return is_square_attacked(square, white); });
 }
@@ -3,6 +3,8 @@
 #define MOVEGEN_H
 
 #include "defs.h"
+#include "attacks.h"
+#include "magic.h"
 
 // preserve board state
 #define copy_board()                                                      \
@@ -22,26 +24,43 @@
     fifty = fifty_copy;                                                   \
     hash_key = hash_key_copy;                                             \
 
-// encode move
-#define encode_move(source, target, piece, promoted, capture, double_push, enpassant, castling) \
-    (source) |          \
-    (target << 6) |     \
-    (piece << 12) |     \
-    (promoted << 16) |  \
-    (capture << 20) |   \
-    (double_push << 21) |    \
-    (enpassant << 22) | \
-    (castling << 23)    \
+// special move flags
+enum { move_normal, move_promotion, move_enpassant, move_castling };
+
+// encode move (16 bits): source (6) | target (6) | promotion type (2) | flag (2)
+// moving piece, capture and double push are derived from the board when needed
+#define encode_move(source, target, promoted, flag) \
+    (U16)((source) |                                                   \
+    ((target) << 6) |                                                  \
+    ((promoted) ? (((unsigned)((promoted) % 6 - N) & 3u) << 12) : 0) | \
+    ((flag) << 14))                                                    \
 
 // EXTRACT DATAS FROM MOVE
-#define get_move_source(move) (move & 0x3f)
-#define get_move_target(move) ((move & 0xfc0) >> 6)
-#define get_move_piece(move) ((move & 0xf000) >> 12)
-#define get_move_promoted(move) ((move & 0xf0000) >> 16)
-#define get_move_capture(move) (move & 0x100000)
-#define get_move_double(move) (move & 0x200000)
-#define get_move_enpassant(move) (move & 0x400000)
-#define get_move_castling(move) (move & 0x800000)
+#define get_move_source(move) ((move) & 0x3f)
+#define get_move_target(move) (((move) & 0xfc0) >> 6)
+#define get_move_flag(move) (((move) & 0xc000) >> 14)
+#define get_move_promoted(move) ((get_move_flag(move) == move_promotion) ? (((move) & 0x3000) >> 12) + N : 0)
+#define get_move_enpassant(move) (get_move_flag(move) == move_enpassant)
+#define get_move_castling(move) (get_move_flag(move) == move_castling)
+
+// EXTRACT DATAS FROM MOVE AND BOARD
+#define get_move_piece(bitboards, side, move) get_piece_on_square(bitboards, side, get_move_source(move))
+#define get_move_capture(occupancies, side, move) (get_bit((occupancies)[(side) ^ 1], get_move_target(move)) || get_move_enpassant(move))
+#define get_move_double(piece, move) (((piece) == P || (piece) == p) && abs(get_move_target(move) - get_move_source(move)) == 16)
+
+// find the piece of given side standing on a square (-1 if empty)
+static inline int get_piece_on_square(const U64* bitboards, int side, int square)
+{
+    int start_piece = (side == white) ? P : p;
+
+    for (int bb_piece = start_piece; bb_piece <= start_piece + K; bb_piece++)
+    {
+        if (get_bit(bitboards[bb_piece], square))
+            return bb_piece;
+    }
+
+    return -1;
+}
 
 // move types
 enum { all_moves, only_captures };
@@ -57,4 +76,172 @@ extern void print_move_list(moves* move_list);
 extern int make_move(int move, int move_flag);
 extern void generate_moves(moves* move_list);
 
+// generation types: captures are moves taking a piece (including en passant),
+// quiets everything else, evasions the check-resolving subset when in check
+enum { gen_all, gen_captures, gen_quiets, gen_evasions };
+
+// squares strictly between two squares on a common line (empty if not aligned)
+static inline U64 squares_between(int source_square, int target_square)
+{
+    U64 source = 1ULL << source_square;
+    U64 target = 1ULL << target_square;
+    if (get_bishop_attacks(source_square, 0ULL) & target)
+        return get_bishop_attacks(source_square, target) & get_bishop_attacks(target_square, source);
+    if (get_rook_attacks(source_square, 0ULL) & target)
+        return get_rook_attacks(source_square, target) & get_rook_attacks(target_square, source);
+    return 0ULL;
+}
+
+// add a move from source square to every target square
+static inline void add_moves(moves* move_list, int source_square, U64 targets)
+{
+    while (targets)
+    {
+        int target_square = get_ls1b_index(targets);
+        move_list->moves[move_list->count++] = encode_move(source_square, target_square, 0, move_normal);
+        pop_bit(targets, target_square);
+    }
+}
+
+// add the four promotions of a pawn move
+static inline void add_promotions(moves* move_list, int source_square, int target_square)
+{
+    move_list->moves[move_list->count++] = encode_move(source_square, target_square, Q, move_promotion);
+    move_list->moves[move_list->count++] = encode_move(source_square, target_square, R, move_promotion);
+    move_list->moves[move_list->count++] = encode_move(source_square, target_square, B, move_promotion);
+    move_list->moves[move_list->count++] = encode_move(source_square, target_square, N, move_promotion);
+}
+
+// pseudo legal move generator specialised on side to move and generation type:
+// pawn directions, promotion ranks and castling squares are constants and the
+// branches of other generation types compile away. attacked(square) tells if
+// the opponent attacks a castling square, checkers is only read for evasions.
+// Moves are appended in the same order as the generic generator used to.
+template <int Color, int GenType, typename Attacked>
+static inline void generate(const U64* bitboards, const U64* occupancies, int enpassant, int castle, U64 checkers, moves* move_list, Attacked attacked)
+{
+    const int them = Color ^ 1;
+    const int offset = (Color == white) ? P : p;
+    const int push = (Color == white) ? -8 : 8;
+    const U64 promotion_rank = (Color == white) ? 0x000000000000FF00ULL : 0x00FF000000000000ULL;
+    const U64 double_rank = (Color == white) ? 0x00FF000000000000ULL : 0x000000000000FF00ULL;
+
+    // destination squares for pieces other than the king
+    U64 targets;
+    if (GenType == gen_all) targets = ~occupancies[Color];
+    else if (GenType == gen_captures) targets = occupancies[them];
+    else if (GenType == gen_quiets) targets = ~occupancies[both];
+    else
+    {
+        // capture the checker or block it; in double check only the king moves
+        int king_square = get_ls1b_index(bitboards[offset + K]);
+        targets = (checkers & (checkers - 1)) ? 0ULL : checkers | squares_between(king_square, get_ls1b_index(checkers));
+    }
+
+    int source_square, target_square;
+    U64 bitboard;
+
+    if (targets)
+    {
+        U64 push_targets = (GenType == gen_evasions) ? targets : ~0ULL;
+        U64 capture_targets = occupancies[them] & ((GenType == gen_evasions) ? targets : ~0ULL);
+
+        // pawn moves
+        bitboard = bitboards[offset + P];
+        while (bitboard)
+        {
+            source_square = get_ls1b_index(bitboard);
+            target_square = source_square + push;
+
+            if (GenType != gen_captures && !get_bit(occupancies[both], target_square))
+            {
+                if (get_bit(promotion_rank, source_square))
+                {
+                    if (get_bit(push_targets, target_square))
+                        add_promotions(move_list, source_square, target_square);
+                }
+                else
+                {
+                    if (get_bit(push_targets, target_square))
+                        move_list->moves[move_list->count++] = encode_move(source_square, target_square, 0, move_normal);
+                    if (get_bit(double_rank, source_square) && !get_bit(occupancies[both], target_square + push) && get_bit(push_targets, target_square + push))
+                        move_list->moves[move_list->count++] = encode_move(source_square, target_square + push, 0, move_normal);
+                }
+            }
+
+            if (GenType != gen_quiets)
+            {
+                U64 attacks = pawn_attacks[Color][source_square] & capture_targets;
+
+                while (attacks)
+                {
+                    target_square = get_ls1b_index(attacks);
+
+                    if (get_bit(promotion_rank, source_square))
+                        add_promotions(move_list, source_square, target_square);
+                    else
+                        move_list->moves[move_list->count++] = encode_move(source_square, target_square, 0, move_normal);
+
+                    pop_bit(attacks, target_square);
+                }
+
+                // en passant is left to the legality test even when evading
+                if (enpassant != no_sq && get_bit(pawn_attacks[Color][source_square], enpassant))
+                    move_list->moves[move_list->count++] = encode_move(source_square, enpassant, 0, move_enpassant);
+            }
+
+            pop_bit(bitboard, source_square);
+        }
+
+        // knight, bishop, rook and queen moves
+        for (int piece = N; piece <= Q; piece++)
+        {
+            bitboard = bitboards[offset + piece];
+            while (bitboard)
+            {
+                source_square = get_ls1b_index(bitboard);
+
+                U64 attacks;
+                if (piece == N) attacks = knight_attacks[source_square];
+                else if (piece == B) attacks = get_bishop_attacks(source_square, occupancies[both]);
+                else if (piece == R) attacks = get_rook_attacks(source_square, occupancies[both]);
+                else attacks = get_queen_attacks(source_square, occupancies[both]);
+
+                add_moves(move_list, source_square, attacks & targets);
+                pop_bit(bitboard, source_square);
+            }
+        }
+    }
+
+    // castling
+    if (GenType == gen_all || GenType == gen_quiets)
+    {
+        const int king_from = (Color == white) ? e1 : e8;
+        const int king_side = (Color == white) ? wk : bk;
+        const int queen_side = (Color == white) ? wq : bq;
+
+        if ((castle & king_side) && !(occupancies[both] & ((1ULL << (king_from + 1)) | (1ULL << (king_from + 2)))))
+        {
+            if (!attacked(king_from) && !attacked(king_from + 1))
+                move_list->moves[move_list->count++] = encode_move(king_from, king_from + 2, 0, move_castling);
+        }
+
+        if ((castle & queen_side) && !(occupancies[both] & ((1ULL << (king_from - 1)) | (1ULL << (king_from - 2)) | (1ULL << (king_from - 3)))))
+        {
+            if (!attacked(king_from) && !attacked(king_from - 1))
+                move_list->moves[move_list->count++] = encode_move(king_from, king_from - 2, 0, move_castling);
+        }
+    }
+
+    // king moves
+    U64 king_targets = (GenType == gen_evasions) ? ~occupancies[Color] : targets;
+    bitboard = bitboards[offset + K];
+    while (bitboard)
+    {
+        source_square = get_ls1b_index(bitboard);
+        add_moves(move_list, source_square, king_attacks[source_square] & king_targets);
+        pop_bit(bitboard, source_square);
+    }
+}
+
 #endif
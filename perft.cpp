@@ -2,6 +2,7 @@
 #include "misc.h"
 #include "movegen.h"
 #include "perft.h"
+#include "io.h"
 
 extern U64 nodes;
 
@@ -62,3 +63,88 @@ void perft_test(int depth)
     printf("    Nodes: %llu\n", nodes);
     printf("     Time: %d\n\n", get_time_ms() - start);
 }
+
+// perft suite position with reference node count
+typedef struct {
+    const char* name;
+    const char* fen;
+    int depth;
+    U64 nodes;
+} perft_position;
+
+// standard positions plus en passant, castling and promotion edge cases
+static const perft_position perft_positions[] = {
+    { "start",               start_position,  5, 4865609ULL },
+    { "tricky",              tricky_position, 4, 4085603ULL },
+    { "killer",              killer_position, 4, 1032012ULL },
+    { "cmk",                 cmk_position,    4, 1679340ULL },
+    { "endgame",             "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624ULL },
+    { "promotions",          "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333ULL },
+    { "underpromotion",      "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487ULL },
+    { "middlegame",          "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594ULL },
+    { "illegal ep 1",        "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888ULL },
+    { "illegal ep 2",        "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133ULL },
+    { "ep gives check",      "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467ULL },
+    { "short castle check",  "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072ULL },
+    { "long castle check",   "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711ULL },
+    { "castle rights",       "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206ULL },
+    { "castle prevented",    "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476ULL },
+    { "promote out of check","2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001ULL },
+    { "discovered check",    "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658ULL },
+    { "promote to check",    "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342ULL },
+    { "underpromote check",  "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683ULL },
+    { "self stalemate",      "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217ULL },
+    { "stalemate/mate 1",    "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584ULL },
+    { "stalemate/mate 2",    "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527ULL },
+};
+
+// perft suite: verify node counts of all reference positions and report throughput
+int perft_suite()
+{
+    int positions = sizeof(perft_positions) / sizeof(perft_positions[0]);
+    int failed = 0;
+    U64 total_nodes = 0;
+    int total_time = 0;
+
+    // the suite sets up its own positions: keep the UCI one
+    static U64 repetition_table_copy[1000];
+    int repetition_index_copy = repetition_index;
+    memcpy(repetition_table_copy, repetition_table, sizeof(repetition_table));
+    copy_board();
+
+    printf("\nPerft suite\n\n");
+    printf("    %-22s %5s %12s %12s %8s %8s\n", "position", "depth", "nodes", "expected", "time", "Mnps");
+
+    for (int index = 0; index < positions; index++)
+    {
+        const perft_position* position = &perft_positions[index];
+
+        parse_fen(position->fen);
+        nodes = 0;
+
+        int start = get_time_ms();
+        perft_driver(position->depth);
+        int elapsed = get_time_ms() - start;
+
+        int passed = (nodes == position->nodes);
+        if (!passed) failed++;
+
+        total_nodes += nodes;
+        total_time += elapsed;
+
+        printf("    %-22s %5d %12llu %12llu %8d %8.2f  %s\n", position->name, position->depth,
+            nodes, position->nodes, elapsed, elapsed > 0 ? (double)nodes / (elapsed * 1000.0) : 0.0,
+            passed ? "ok" : "FAILED");
+    }
+
+    printf("\n   Passed: %d/%d\n", positions - failed, positions);
+    printf("    Nodes: %llu\n", total_nodes);
+    printf("     Time: %d\n", total_time);
+    printf("     Mnps: %.2f\n\n", total_time > 0 ? (double)total_nodes / (total_time * 1000.0) : 0.0);
+
+    take_back();
+    memcpy(repetition_table, repetition_table_copy, sizeof(repetition_table));
+    repetition_index = repetition_index_copy;
+
+    return failed;
+}
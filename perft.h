@@ -10,5 +10,6 @@ extern U64 nodes;
 
 extern void perft_driver(int depth);
 extern void perft_test(int depth);
+extern int perft_suite();
 
 #endif
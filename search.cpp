@@ -1,7 +1,7 @@
 #include <vector>
 #include "search.h"
 #include "defs.h"
-#include "tt.h"
+#include "tt_new.h"
 #include "movegen.h"
 #include "misc.h"
 #include "evaluation.h"
@@ -38,9 +38,9 @@ static inline int score_move(int move)
         }
     }
 
-    if (get_move_capture(move))
+    if (get_move_capture(occupancies, side, move))
     {
-        int piece = get_move_piece(move);
+        int piece = get_move_piece(bitboards, side, move);
         int target_piece = P;
         int start_piece, end_piece;
 
@@ -65,7 +65,7 @@ static inline int score_move(int move)
         else if (killer_moves[1][ply] == move)
             return 8000;
         else
-            return history_moves[get_move_piece(move)][get_move_target(move)];
+            return history_moves[get_move_piece(bitboards, side, move)][get_move_target(move)];
     }
 
     return 0;
@@ -271,13 +271,17 @@ static inline int negamax(int alpha, int beta, int depth)
 
     for (int count = 0; count < move_list->count; count++)
     {
+        int move = move_list->moves[count];
+        int piece = get_move_piece(bitboards, side, move);
+        int capture = get_move_capture(occupancies, side, move);
+
         copy_board();
 
         ply++;
         repetition_index++;
         repetition_table[repetition_index] = hash_key;
 
-        if (make_move(move_list->moves[count], all_moves) == 0)
+        if (make_move(move, all_moves) == 0)
         {
             ply--;
             repetition_index--;
@@ -294,8 +298,8 @@ static inline int negamax(int alpha, int beta, int depth)
             if (moves_searched >= full_depth_moves &&
                 depth >= reduction_limit &&
                 in_check == 0 &&
-                get_move_capture(move_list->moves[count]) == 0 &&
-                get_move_promoted(move_list->moves[count]) == 0)
+                capture == 0 &&
+                get_move_promoted(move) == 0)
                 score = -negamax(-alpha - 1, -alpha, depth - 2);
             else
                 score = alpha + 1;
@@ -320,14 +324,14 @@ static inline int negamax(int alpha, int beta, int depth)
         if (score > alpha)
         {
             hash_flag = hash_flag_exact;
-            best_move = move_list->moves[count];
+            best_move = move;
 
-            if (get_move_capture(move_list->moves[count]) == 0)
-                history_moves[get_move_piece(move_list->moves[count])][get_move_target(move_list->moves[count])] += depth;
+            if (capture == 0)
+                history_moves[piece][get_move_target(move)] += depth;
 
             alpha = score;
 
-            pv_table[ply][ply] = move_list->moves[count];
+            pv_table[ply][ply] = move;
 
             for (int next_ply = ply + 1; next_ply < pv_length[ply + 1]; next_ply++)
                 pv_table[ply][next_ply] = pv_table[ply + 1][next_ply];
@@ -338,10 +342,10 @@ static inline int negamax(int alpha, int beta, int depth)
             {
                 write_hash_entry(beta, best_move, depth, hash_flag_beta);
 
-                if (get_move_capture(move_list->moves[count]) == 0)
+                if (capture == 0)
                 {
                     killer_moves[1][ply] = killer_moves[0][ply];
-                    killer_moves[0][ply] = move_list->moves[count];
+                    killer_moves[0][ply] = move;
                 }
 
                 return beta;
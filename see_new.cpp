@@ -3,7 +3,7 @@
  * Determines if a capture wins or loses material
  */
 
-#include "see.h"
+#include "see_new.h"
 #include "defs.h"
 #include "movegen.h"
 #include "magic.h"
@@ -15,69 +15,21 @@ const int see_piece_values[12] = {
     100, 320, 330, 500, 900, 20000   // p n b r q k
 };
 
-// Get the least valuable attacker of a square
-static inline int get_smallest_attacker(U64 bb[12], U64 occ[3], int square, int side, int* from_sq) {
-    U64 attackers;
-    
-    // Pawns (least valuable)
-    if (side == white) {
-        attackers = pawn_attacks[black][square] & bb[P];
-    } else {
-        attackers = pawn_attacks[white][square] & bb[p];
-    }
-    if (attackers) {
-        *from_sq = get_ls1b_index(attackers);
-        return (side == white) ? P : p;
-    }
-    
-    // Knights
-    int knight = (side == white) ? N : n;
-    attackers = knight_attacks[square] & bb[knight];
-    if (attackers) {
-        *from_sq = get_ls1b_index(attackers);
-        return knight;
-    }
-    
-    // Bishops
-    int bishop = (side == white) ? B : b;
-    attackers = get_bishop_attacks(square, occ[both]) & bb[bishop];
-    if (attackers) {
-        *from_sq = get_ls1b_index(attackers);
-        return bishop;
-    }
-    
-    // Rooks
-    int rook_piece = (side == white) ? R : r;
-    attackers = get_rook_attacks(square, occ[both]) & bb[rook_piece];
-    if (attackers) {
-        *from_sq = get_ls1b_index(attackers);
-        return rook_piece;
-    }
-    
-    // Queens
-    int queen = (side == white) ? Q : q;
-    attackers = get_queen_attacks(square, occ[both]) & bb[queen];
-    if (attackers) {
-        *from_sq = get_ls1b_index(attackers);
-        return queen;
-    }
-    
-    // King
-    int king = (side == white) ? K : k;
-    attackers = king_attacks[square] & bb[king];
-    if (attackers) {
-        *from_sq = get_ls1b_index(attackers);
-        return king;
-    }
-    
-    return -1; // No attacker
+// Attackers of both sides to a square for a given occupancy
+static inline U64 attackers_to(ThreadData& td, int square, U64 occupancy) {
+    return (pawn_attacks[black][square] & td.bitboards[P])
+         | (pawn_attacks[white][square] & td.bitboards[p])
+         | (knight_attacks[square] & (td.bitboards[N] | td.bitboards[n]))
+         | (get_bishop_attacks(square, occupancy) & (td.bitboards[B] | td.bitboards[b] | td.bitboards[Q] | td.bitboards[q]))
+         | (get_rook_attacks(square, occupancy) & (td.bitboards[R] | td.bitboards[r] | td.bitboards[Q] | td.bitboards[q]))
+         | (king_attacks[square] & (td.bitboards[K] | td.bitboards[k]));
 }
 
 // Static Exchange Evaluation
 int td_see(ThreadData& td, int move) {
     int from = get_move_source(move);
     int to = get_move_target(move);
-    int piece = get_move_piece(move);
+    int piece = get_move_piece(td.bitboards, td.side, move);
     int captured = -1;
     
     // Find the captured piece
@@ -99,78 +51,69 @@ int td_see(ThreadData& td, int move) {
     // Not a capture
     if (captured == -1) return 0;
     
-    // Make local copies for simulation
-    U64 bb[12], occ[3];
-    memcpy(bb, td.bitboards, sizeof(td.bitboards));
-    memcpy(occ, td.occupancies, sizeof(td.occupancies));
-    
+    U64 diagonal = td.bitboards[B] | td.bitboards[b] | td.bitboards[Q] | td.bitboards[q];
+    U64 straight = td.bitboards[R] | td.bitboards[r] | td.bitboards[Q] | td.bitboards[q];
+    U64 occupancy = td.occupancies[both];
+    pop_bit(occupancy, from);
+
+    // Undefended target (node attack map): the capture stands unless an
+    // enemy slider behind the source square joins in
+    if (!get_move_enpassant(move) && !get_bit(td_attack_info(td).attacked, to)) {
+        U64 xray = (get_bishop_attacks(to, 0ULL) & (1ULL << from))
+                 ? get_bishop_attacks(to, occupancy) & diagonal
+                 : get_rook_attacks(to, occupancy) & straight;
+        if (!(xray & td.occupancies[td.side ^ 1])) return see_piece_values[captured];
+    }
+
+    if (get_move_enpassant(move)) pop_bit(occupancy, (td.side == white) ? to + 8 : to - 8);
+
+    // Attackers are computed once; sliders behind a removed piece are added as x-rays
+    U64 attackers = attackers_to(td, to, occupancy) & occupancy;
+
     int gain[32];
     int d = 0;
-    int current_side = td.side;
-    
+    int current_side = td.side ^ 1;
+
     // Initial material gain
     gain[0] = see_piece_values[captured];
-    
-    // Remove attacker from source square
-    pop_bit(bb[piece], from);
-    pop_bit(occ[current_side], from);
-    pop_bit(occ[both], from);
-    
-    // Remove captured piece from target square
-    pop_bit(bb[captured], to);
-    pop_bit(occ[current_side ^ 1], to);
-    
-    // Place attacker on target square
-    set_bit(bb[piece], to);
-    set_bit(occ[current_side], to);
-    set_bit(occ[both], to);
-    
     int attacker_value = see_piece_values[piece];
-    current_side ^= 1;
-    
+
     // Simulate the exchange
     while (d < 31) {
         d++;
-        
-        int from_sq;
-        int attacker = get_smallest_attacker(bb, occ, to, current_side, &from_sq);
-        
-        // No more attackers
-        if (attacker == -1) break;
-        
+
+        // Least valuable attacker of the side to recapture
+        U64 side_attackers = attackers & td.occupancies[current_side];
+        if (!side_attackers) break;
+
+        int attacker = (current_side == white) ? P : p;
+        while (!(side_attackers & td.bitboards[attacker])) attacker++;
+        int from_sq = get_ls1b_index(side_attackers & td.bitboards[attacker]);
+
         // Calculate gain for this capture
         gain[d] = attacker_value - gain[d - 1];
-        
+
         // Stand-pat: if we're already winning, we can stop
         if (-gain[d - 1] < 0 && gain[d] < 0) break;
-        
+
         attacker_value = see_piece_values[attacker];
-        
-        // Remove this attacker from its square
-        pop_bit(bb[attacker], from_sq);
-        pop_bit(occ[current_side], from_sq);
-        pop_bit(occ[both], from_sq);
-        
-        // Remove the current piece on target (it gets captured)
-        for (int pc = P; pc <= k; pc++) {
-            if (get_bit(bb[pc], to)) {
-                pop_bit(bb[pc], to);
-                break;
-            }
-        }
-        
-        // Place attacker on target
-        set_bit(bb[attacker], to);
-        set_bit(occ[current_side], to);
-        set_bit(occ[both], to);
-        
+
+        // Remove this attacker and uncover the sliders behind it
+        pop_bit(occupancy, from_sq);
+        int type = attacker % 6;
+        if (type == P || type == B || type == Q)
+            attackers |= get_bishop_attacks(to, occupancy) & diagonal;
+        if (type == R || type == Q)
+            attackers |= get_rook_attacks(to, occupancy) & straight;
+        attackers &= occupancy;
+
         current_side ^= 1;
     }
-    
+
     // Negamax the gain array
     while (--d > 0) {
         gain[d - 1] = -((-gain[d - 1] > gain[d]) ? -gain[d - 1] : gain[d]);
     }
-    
+
     return gain[0];
 }
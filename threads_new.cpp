@@ -17,40 +17,242 @@
 #include "evaluation.h"
 #include "magic.h"
 #include "attacks.h"
-#include "see.h"
+#include "see_new.h"
 #include <algorithm>
 #include <iostream>
+#include <chrono>
+#include <new>
+#include <string>
 #include "defs.h"
+#include "io.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
 
 // Global thread management variables
 std::vector<std::thread> search_threads;
-std::vector<ThreadData> thread_data;
+std::vector<ThreadData*> thread_data;
 std::atomic<bool> stop_threads(false);
 std::atomic<U64> total_nodes(0);
 std::atomic<int> best_thread_id(0);
 std::mutex output_mutex;
 int num_threads = 1;
 int search_start_time = 0;
+int bind_threads = 0;
+int skip_schedule = 1;
+int smp_mode = smp_lazy;
+int search_quiet = 0;
+
+// Worker pool: helpers park on pool_wakeup between searches
+static std::mutex pool_mutex;
+static std::condition_variable pool_wakeup;
+static std::condition_variable pool_finished;
+static int pool_search_id = 0;   // incremented for every search
+static int pool_depth = 0;
+static int pool_active = 0;      // helpers still searching
+static bool pool_exit = false;
+
+static int pool_ready = 0;       // threads that have set up their ThreadData
+static std::condition_variable pool_setup;
+
+static void worker_loop(int thread_id, int last_search_id);
+static void driver_loop();
+static void root_split_worker(ThreadData& td, int depth);
+static void root_split_search(int depth);
+static void batch_worker(ThreadData& td, int depth);
+static void batch_search(int depth);
+
+// Search driver: runs search_position_mt off the UCI thread
+static std::thread driver_thread;
+static std::condition_variable driver_wakeup;
+static std::condition_variable driver_idle;
+static int driver_depth = 0;
+static int search_task = task_search;   // what the driver and the pool run
+static bool driver_busy = false;
+static bool driver_exit = false;
+
+// Timer: sleeps until stoptime and then raises stop_threads
+static std::thread timer_thread;
+static std::condition_variable timer_wakeup;
+static int timer_deadline = 0;      // get_time_ms() value, valid while armed
+static bool timer_armed = false;
+
+#ifdef _WIN32
+
+static int numa_node_count() {
+    ULONG highest = 0;
+    if (!GetNumaHighestNodeNumber(&highest)) return 1;
+    return (int)highest + 1;
+}
+
+// Restrict the calling thread to the processors of a node
+static void bind_to_node(int node) {
+    GROUP_AFFINITY affinity;
+    memset(&affinity, 0, sizeof(affinity));
+    if (GetNumaNodeProcessorMaskEx((USHORT)node, &affinity) && affinity.Mask)
+        SetThreadGroupAffinity(GetCurrentThread(), &affinity, NULL);
+}
+
+static void* node_alloc(size_t size, int node) {
+    if (node < 0)
+        return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    return VirtualAllocExNuma(GetCurrentProcess(), NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, (DWORD)node);
+}
+
+static void node_free(void* memory) {
+    VirtualFree(memory, 0, MEM_RELEASE);
+}
+
+#else
+
+static int numa_node_count() {
+    int nodes = 0;
+    char path[64];
+    while (nodes < MAX_THREADS) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes);
+        FILE* file = fopen(path, "r");
+        if (!file) break;
+        fclose(file);
+        nodes++;
+    }
+    return nodes ? nodes : 1;
+}
+
+// Restrict the calling thread to the cpus of a node (cpulist format "0-7,16-23")
+static void bind_to_node(int node) {
+    char path[64], list[1024];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE* file = fopen(path, "r");
+    if (!file) return;
+    int ok = fgets(list, sizeof(list), file) != NULL;
+    fclose(file);
+    if (!ok) return;
+
+    // parsed with a local cursor: strtok would race with other threads
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    char* range = list;
+    while (*range) {
+        int first, last;
+        int fields = sscanf(range, "%d-%d", &first, &last);
+        if (fields >= 1) {
+            if (fields == 1) last = first;
+            for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+                CPU_SET(cpu, &cpus);
+        }
+
+        range += strcspn(range, ",");
+        if (*range) range++;
+    }
+    if (CPU_COUNT(&cpus))
+        sched_setaffinity(0, sizeof(cpus), &cpus);
+}
+
+// Pages are placed on the node of the thread that touches them first
+static void* node_alloc(size_t size, int node) {
+    (void)node;
+    return aligned_alloc(64, (size + 63) & ~(size_t)63);
+}
+
+static void node_free(void* memory) {
+    free(memory);
+}
+
+#endif
+
+// Node of a thread: consecutive threads share a node, nodes get equal shares
+static int thread_node(int thread_id) {
+    int nodes = numa_node_count();
+    if (!bind_threads || nodes < 2) return -1;
+    return thread_id * nodes / num_threads;
+}
+
+// Move the calling thread onto the node of a search thread (no-op unbound)
+void bind_to_thread_node(int thread_id) {
+    int node = thread_node(thread_id);
+    if (node >= 0) bind_to_node(node);
+}
+
+// Allocate a zeroed ThreadData on a node (node_alloc is 64-byte aligned)
+static ThreadData* alloc_thread_data(int thread_id, int node) {
+    void* memory = node_alloc(sizeof(ThreadData), node);
+    if (!memory) return NULL;
+
+    ThreadData* td = new (memory) ThreadData();
+    td->thread_id = thread_id;
+    td->best_score = -infinity;
+    return td;
+}
+
+// Runs on each search thread before its first search: bind to the node,
+// then allocate and first-touch the thread's own ThreadData there
+static void thread_setup(int thread_id) {
+    bind_to_thread_node(thread_id);
+
+    ThreadData* td = alloc_thread_data(thread_id, thread_node(thread_id));
+
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    thread_data[thread_id] = td;
+    pool_ready++;
+    pool_setup.notify_all();
+}
 
 // Initialize thread pool
 void init_threads(int thread_count) {
     if (thread_count < 1) thread_count = 1;
     if (thread_count > MAX_THREADS) thread_count = MAX_THREADS;
 
+    // Workers refer to thread_data, stop them before it is replaced
+    release_threads();
+
     num_threads = thread_count;
-    thread_data.resize(num_threads);
+    thread_data.assign(num_threads, NULL);
+    pool_ready = 0;
+
+    // Thread 0 searches on the driver thread
+    driver_thread = std::thread(driver_loop);
+    for (int i = 1; i < num_threads; i++)
+        search_threads.emplace_back(worker_loop, i, pool_search_id);
 
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    pool_setup.wait(lock, [] { return pool_ready == num_threads; });
+
+    // Fall back to the default heap if a node allocation failed
     for (int i = 0; i < num_threads; i++) {
-        thread_data[i].thread_id = i;
-        thread_data[i].nodes = 0;
-        thread_data[i].best_move = 0;
-        thread_data[i].best_score = -infinity;
-        thread_data[i].completed_depth = 0;
-        memset(thread_data[i].killer_moves, 0, sizeof(thread_data[i].killer_moves));
-        memset(thread_data[i].history_moves, 0, sizeof(thread_data[i].history_moves));
-        memset(thread_data[i].pv_table, 0, sizeof(thread_data[i].pv_table));
-        memset(thread_data[i].pv_length, 0, sizeof(thread_data[i].pv_length));
+        if (!thread_data[i])
+            thread_data[i] = alloc_thread_data(i, -1);
+    }
+}
+
+// Join the search driver and all parked workers
+void release_threads() {
+    wait_for_search();
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        pool_exit = true;
+        driver_exit = true;
+    }
+    pool_wakeup.notify_all();
+    driver_wakeup.notify_all();
+    timer_wakeup.notify_all();
+
+    if (driver_thread.joinable())
+        driver_thread.join();
+    if (timer_thread.joinable())
+        timer_thread.join();
+    for (auto& t : search_threads) {
+        if (t.joinable())
+            t.join();
     }
+    search_threads.clear();
+    pool_exit = false;
+    driver_exit = false;
+
+    for (ThreadData* td : thread_data)
+        if (td) node_free(td);
+    thread_data.clear();
 }
 
 // Copy global board state to thread-local storage
@@ -62,10 +264,14 @@ void copy_board_to_thread(ThreadData& td) {
     td.castle = castle;
     td.hash_key = hash_key;
     td.fifty = fifty;
-    memcpy(td.repetition_table, repetition_table, sizeof(repetition_table));
+    memcpy(td.repetition_table, repetition_table, (repetition_index + 1) * sizeof(U64));
     td.repetition_index = repetition_index;
+    td.last_null_ply = -max_ply;
     td.ply = 0;
-    td.nodes = 0;
+    td.nodes.store(0, std::memory_order_relaxed);
+    tt_clear_stats(&td.tt);
+    td.tt_table = hash_table;
+    td.tt_buckets = hash_buckets;
     td.best_move = 0;
     td.best_score = -infinity;
     td.completed_depth = 0;
@@ -83,219 +289,76 @@ static inline int td_is_square_attacked(ThreadData& td, int square, int attacker
     return 0;
 }
 
-// Thread-local move generation (same as original but uses td state)
-static void td_generate_moves(ThreadData& td, moves* move_list) {
-    move_list->count = 0;
-    int source_square, target_square;
-    U64 bitboard, attacks;
-
-    for (int piece = P; piece <= k; piece++) {
-        bitboard = td.bitboards[piece];
-
-        if (td.side == white) {
-            if (piece == P) {
-                while (bitboard) {
-                    source_square = get_ls1b_index(bitboard);
-                    target_square = source_square - 8;
-                    if (!(target_square < a8) && !get_bit(td.occupancies[both], target_square)) {
-                        if (source_square >= a7 && source_square <= h7) {
-                            add_move(move_list, encode_move(source_square, target_square, piece, Q, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, R, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, B, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, N, 0, 0, 0, 0));
-                        }
-                        else {
-                            add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                            if ((source_square >= a2 && source_square <= h2) && !get_bit(td.occupancies[both], target_square - 8))
-                                add_move(move_list, encode_move(source_square, target_square - 8, piece, 0, 0, 1, 0, 0));
-                        }
-                    }
-                    attacks = pawn_attacks[td.side][source_square] & td.occupancies[black];
-                    while (attacks) {
-                        target_square = get_ls1b_index(attacks);
-                        if (source_square >= a7 && source_square <= h7) {
-                            add_move(move_list, encode_move(source_square, target_square, piece, Q, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, R, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, B, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, N, 1, 0, 0, 0));
-                        }
-                        else {
-                            add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                        }
-                        pop_bit(attacks, target_square);
-                    }
-                    if (td.enpassant != no_sq) {
-                        U64 enpassant_attacks = pawn_attacks[td.side][source_square] & (1ULL << td.enpassant);
-                        if (enpassant_attacks) {
-                            int target_enpassant = get_ls1b_index(enpassant_attacks);
-                            add_move(move_list, encode_move(source_square, target_enpassant, piece, 0, 1, 0, 1, 0));
-                        }
-                    }
-                    pop_bit(bitboard, source_square);
-                }
-            }
-            if (piece == K) {
-                if (td.castle & wk) {
-                    if (!get_bit(td.occupancies[both], f1) && !get_bit(td.occupancies[both], g1)) {
-                        if (!td_is_square_attacked(td, e1, black) && !td_is_square_attacked(td, f1, black))
-                            add_move(move_list, encode_move(e1, g1, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-                if (td.castle & wq) {
-                    if (!get_bit(td.occupancies[both], d1) && !get_bit(td.occupancies[both], c1) && !get_bit(td.occupancies[both], b1)) {
-                        if (!td_is_square_attacked(td, e1, black) && !td_is_square_attacked(td, d1, black))
-                            add_move(move_list, encode_move(e1, c1, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-            }
-        }
-        else {
-            if (piece == p) {
-                while (bitboard) {
-                    source_square = get_ls1b_index(bitboard);
-                    target_square = source_square + 8;
-                    if (!(target_square > h1) && !get_bit(td.occupancies[both], target_square)) {
-                        if (source_square >= a2 && source_square <= h2) {
-                            add_move(move_list, encode_move(source_square, target_square, piece, q, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, r, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, b, 0, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, n, 0, 0, 0, 0));
-                        }
-                        else {
-                            add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                            if ((source_square >= a7 && source_square <= h7) && !get_bit(td.occupancies[both], target_square + 8))
-                                add_move(move_list, encode_move(source_square, target_square + 8, piece, 0, 0, 1, 0, 0));
-                        }
-                    }
-                    attacks = pawn_attacks[td.side][source_square] & td.occupancies[white];
-                    while (attacks) {
-                        target_square = get_ls1b_index(attacks);
-                        if (source_square >= a2 && source_square <= h2) {
-                            add_move(move_list, encode_move(source_square, target_square, piece, q, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, r, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, b, 1, 0, 0, 0));
-                            add_move(move_list, encode_move(source_square, target_square, piece, n, 1, 0, 0, 0));
-                        }
-                        else {
-                            add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                        }
-                        pop_bit(attacks, target_square);
-                    }
-                    if (td.enpassant != no_sq) {
-                        U64 enpassant_attacks = pawn_attacks[td.side][source_square] & (1ULL << td.enpassant);
-                        if (enpassant_attacks) {
-                            int target_enpassant = get_ls1b_index(enpassant_attacks);
-                            add_move(move_list, encode_move(source_square, target_enpassant, piece, 0, 1, 0, 1, 0));
-                        }
-                    }
-                    pop_bit(bitboard, source_square);
-                }
-            }
-            if (piece == k) {
-                if (td.castle & bk) {
-                    if (!get_bit(td.occupancies[both], f8) && !get_bit(td.occupancies[both], g8)) {
-                        if (!td_is_square_attacked(td, e8, white) && !td_is_square_attacked(td, f8, white))
-                            add_move(move_list, encode_move(e8, g8, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-                if (td.castle & bq) {
-                    if (!get_bit(td.occupancies[both], d8) && !get_bit(td.occupancies[both], c8) && !get_bit(td.occupancies[both], b8)) {
-                        if (!td_is_square_attacked(td, e8, white) && !td_is_square_attacked(td, d8, white))
-                            add_move(move_list, encode_move(e8, c8, piece, 0, 0, 0, 0, 1));
-                    }
-                }
-            }
-        }
+// Squares attacked by one side for a given occupancy
+static inline U64 td_side_attacks(ThreadData& td, int attacker_side, U64 occupancy) {
+    int offset = (attacker_side == white) ? P : p;
+    U64 attacks = 0ULL, bitboard;
+
+    for (bitboard = td.bitboards[offset + P]; bitboard; pop_bit(bitboard, get_ls1b_index(bitboard)))
+        attacks |= pawn_attacks[attacker_side][get_ls1b_index(bitboard)];
+    for (bitboard = td.bitboards[offset + N]; bitboard; pop_bit(bitboard, get_ls1b_index(bitboard)))
+        attacks |= knight_attacks[get_ls1b_index(bitboard)];
+    for (bitboard = td.bitboards[offset + B] | td.bitboards[offset + Q]; bitboard; pop_bit(bitboard, get_ls1b_index(bitboard)))
+        attacks |= get_bishop_attacks(get_ls1b_index(bitboard), occupancy);
+    for (bitboard = td.bitboards[offset + R] | td.bitboards[offset + Q]; bitboard; pop_bit(bitboard, get_ls1b_index(bitboard)))
+        attacks |= get_rook_attacks(get_ls1b_index(bitboard), occupancy);
+    attacks |= king_attacks[get_ls1b_index(td.bitboards[offset + K])];
+
+    return attacks;
+}
 
-        // Knight moves
-        if ((td.side == white) ? piece == N : piece == n) {
-            while (bitboard) {
-                source_square = get_ls1b_index(bitboard);
-                attacks = knight_attacks[source_square] & ((td.side == white) ? ~td.occupancies[white] : ~td.occupancies[black]);
-                while (attacks) {
-                    target_square = get_ls1b_index(attacks);
-                    if (!get_bit(((td.side == white) ? td.occupancies[black] : td.occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
-            }
-        }
+// Fill the attack information of the current position
+void td_compute_attack_info(ThreadData& td, AttackInfo& info) {
+    int us = td.side, them = td.side ^ 1;
+    int offset = (them == white) ? P : p;
+    int king_square = get_ls1b_index(td.bitboards[(us == white) ? K : k]);
+    U64 occupancy = td.occupancies[both];
+
+    // Enemy attacks ignore our king so that stepping back along a checking ray is refused
+    info.attacked = td_side_attacks(td, them, occupancy ^ (1ULL << king_square));
+
+    U64 diagonal = td.bitboards[offset + B] | td.bitboards[offset + Q];
+    U64 straight = td.bitboards[offset + R] | td.bitboards[offset + Q];
+
+    info.checkers = (pawn_attacks[us][king_square] & td.bitboards[offset + P])
+                  | (knight_attacks[king_square] & td.bitboards[offset + N])
+                  | (get_bishop_attacks(king_square, occupancy) & diagonal)
+                  | (get_rook_attacks(king_square, occupancy) & straight);
+
+    // A single own piece between the king and an enemy slider is pinned
+    info.pinned = 0ULL;
+    U64 snipers = (get_bishop_attacks(king_square, 0ULL) & diagonal) | (get_rook_attacks(king_square, 0ULL) & straight);
+    while (snipers) {
+        int sniper_square = get_ls1b_index(snipers);
+        U64 blockers = squares_between(king_square, sniper_square) & occupancy;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & td.occupancies[us]))
+            info.pinned |= blockers;
+        pop_bit(snipers, sniper_square);
+    }
 
-        // Bishop moves
-        if ((td.side == white) ? piece == B : piece == b) {
-            while (bitboard) {
-                source_square = get_ls1b_index(bitboard);
-                attacks = get_bishop_attacks(source_square, td.occupancies[both]) & ((td.side == white) ? ~td.occupancies[white] : ~td.occupancies[black]);
-                while (attacks) {
-                    target_square = get_ls1b_index(attacks);
-                    if (!get_bit(((td.side == white) ? td.occupancies[black] : td.occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
-            }
-        }
+    info.key = td.hash_key;
+}
 
-        // Rook moves
-        if ((td.side == white) ? piece == R : piece == r) {
-            while (bitboard) {
-                source_square = get_ls1b_index(bitboard);
-                attacks = get_rook_attacks(source_square, td.occupancies[both]) & ((td.side == white) ? ~td.occupancies[white] : ~td.occupancies[black]);
-                while (attacks) {
-                    target_square = get_ls1b_index(attacks);
-                    if (!get_bit(((td.side == white) ? td.occupancies[black] : td.occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
-            }
-        }
+// Bucket of a key in the part of the hash table the thread searches in
+static inline tt_bucket* td_bucket_of(ThreadData& td, U64 key) {
+    return &td.tt_table[tt_index(key, td.tt_buckets)];
+}
 
-        // Queen moves
-        if ((td.side == white) ? piece == Q : piece == q) {
-            while (bitboard) {
-                source_square = get_ls1b_index(bitboard);
-                attacks = get_queen_attacks(source_square, td.occupancies[both]) & ((td.side == white) ? ~td.occupancies[white] : ~td.occupancies[black]);
-                while (attacks) {
-                    target_square = get_ls1b_index(attacks);
-                    if (!get_bit(((td.side == white) ? td.occupancies[black] : td.occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
-            }
-        }
+// Thread-local move generation of one generation type
+template <int GenType>
+static inline void td_generate_moves(ThreadData& td, moves* move_list) {
+    move_list->count = 0;
+    auto attacked = [&td](int square) { return get_bit(td_attack_info(td).attacked, square) != 0; };
+    U64 checkers = (GenType == gen_evasions) ? td_attack_info(td).checkers : 0ULL;
 
-        // King moves
-        if ((td.side == white) ? piece == K : piece == k) {
-            while (bitboard) {
-                source_square = get_ls1b_index(bitboard);
-                attacks = king_attacks[source_square] & ((td.side == white) ? ~td.occupancies[white] : ~td.occupancies[black]);
-                while (attacks) {
-                    target_square = get_ls1b_index(attacks);
-                    if (!get_bit(((td.side == white) ? td.occupancies[black] : td.occupancies[white]), target_square))
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0));
-                    else
-                        add_move(move_list, encode_move(source_square, target_square, piece, 0, 1, 0, 0, 0));
-                    pop_bit(attacks, target_square);
-                }
-                pop_bit(bitboard, source_square);
-            }
-        }
-    }
+    if (td.side == white)
+        generate<white, GenType>(td.bitboards, td.occupancies, td.enpassant, td.castle, checkers, move_list, attacked);
+    else
+        generate<black, GenType>(td.bitboards, td.occupancies, td.enpassant, td.castle, checkers, move_list, attacked);
 }
 
 // Thread-local make move
-static inline int td_make_move(ThreadData& td, int move, int move_flag) {
+static inline int td_make_move(ThreadData& td, int move, int move_flag, const AttackInfo* info) {
     if (move_flag == all_moves) {
         // Save state for restoration
         U64 bitboards_copy[12], occupancies_copy[3];
@@ -308,13 +371,25 @@ static inline int td_make_move(ThreadData& td, int move, int move_flag) {
 
         int source_square = get_move_source(move);
         int target_square = get_move_target(move);
-        int piece = get_move_piece(move);
+        int piece = get_move_piece(td.bitboards, td.side, move);
         int promoted_piece = get_move_promoted(move);
-        int capture = get_move_capture(move);
-        int double_push = get_move_double(move);
+        int capture = get_move_capture(td.occupancies, td.side, move);
+        int double_push = get_move_double(piece, move);
         int enpass = get_move_enpassant(move);
         int castling = get_move_castling(move);
 
+        // With the node's attack information only king moves, en passant,
+        // pinned pieces and check evasions need the test after the move
+        int verify = 1;
+        if (info) {
+            if (piece == K || piece == k) {
+                if (info->attacked & (1ULL << target_square)) return 0;
+                verify = 0;
+            }
+            else if (!info->checkers && !enpass && !get_bit(info->pinned, source_square))
+                verify = 0;
+        }
+
         pop_bit(td.bitboards[piece], source_square);
         set_bit(td.bitboards[piece], target_square);
         td.hash_key ^= piece_keys[piece][source_square];
@@ -346,6 +421,7 @@ static inline int td_make_move(ThreadData& td, int move, int move_flag) {
                 pop_bit(td.bitboards[p], target_square);
                 td.hash_key ^= piece_keys[p][target_square];
             }
+            if (td.side == black) promoted_piece += p;
             set_bit(td.bitboards[promoted_piece], target_square);
             td.hash_key ^= piece_keys[promoted_piece][target_square];
         }
@@ -401,6 +477,13 @@ static inline int td_make_move(ThreadData& td, int move, int move_flag) {
         td.castle &= castling_rights[target_square];
         td.hash_key ^= castle_keys[td.castle];
 
+        td.side ^= 1;
+        td.hash_key ^= side_key;
+
+        // The child's key is final: start loading its bucket while the
+        // occupancies, legality and repetition checks run
+        tt_prefetch(td_bucket_of(td, td.hash_key));
+
         memset(td.occupancies, 0ULL, 24);
         for (int bb_piece = P; bb_piece <= K; bb_piece++)
             td.occupancies[white] |= td.bitboards[bb_piece];
@@ -408,11 +491,8 @@ static inline int td_make_move(ThreadData& td, int move, int move_flag) {
             td.occupancies[black] |= td.bitboards[bb_piece];
         td.occupancies[both] = td.occupancies[white] | td.occupancies[black];
 
-        td.side ^= 1;
-        td.hash_key ^= side_key;
-
         // Check if move leaves own king in check
-        if (td_is_square_attacked(td, (td.side == white) ? get_ls1b_index(td.bitboards[k]) : get_ls1b_index(td.bitboards[K]), td.side)) {
+        if (verify && td_is_square_attacked(td, (td.side == white) ? get_ls1b_index(td.bitboards[k]) : get_ls1b_index(td.bitboards[K]), td.side)) {
             memcpy(td.bitboards, bitboards_copy, 96);
             memcpy(td.occupancies, occupancies_copy, 24);
             td.side = side_copy; td.enpassant = enpassant_copy;
@@ -423,8 +503,8 @@ static inline int td_make_move(ThreadData& td, int move, int move_flag) {
         return 1;
     }
     else {
-        if (get_move_capture(move))
-            return td_make_move(td, move, all_moves);
+        if (get_move_capture(td.occupancies, td.side, move))
+            return td_make_move(td, move, all_moves, info);
         else
             return 0;
     }
@@ -464,21 +544,72 @@ static inline int td_evaluate(ThreadData& td) {
     return (evaluate_nnue(td.side, pieces, squares) * (100 - td.fifty) / 100);
 }
 
-// Thread-local repetition detection
+// Number of plies back that can hold a repetition: positions before the last
+// irreversible move (fifty counter) or null move can never recur
+static inline int td_repetition_window(ThreadData& td) {
+    int end = td.fifty;
+    if (end > td.ply - td.last_null_ply) end = td.ply - td.last_null_ply;
+    if (end > td.repetition_index) end = td.repetition_index;
+    return end;
+}
+
+// Key of the position "distance" plies before the current one
+#define td_history_key(td, distance) ((td).repetition_table[(td).repetition_index + 1 - (distance)])
+
+// Thread-local repetition detection (same side to move only, two plies at a time)
 static inline int td_is_repetition(ThreadData& td) {
-    for (int index = 0; index < td.repetition_index; index++)
-        if (td.repetition_table[index] == td.hash_key)
+    int end = td_repetition_window(td);
+    for (int distance = 4; distance <= end; distance += 2)
+        if (td_history_key(td, distance) == td.hash_key)
             return 1;
     return 0;
 }
 
+// Upcoming repetition detection: the side to move can return to an earlier
+// position of the search path with a single reversible move (cuckoo tables)
+static inline int td_has_game_cycle(ThreadData& td) {
+    int end = td_repetition_window(td);
+    if (end < 3) return 0;
+
+    U64 original_key = td.hash_key;
+    U64 other = original_key ^ td_history_key(td, 1) ^ side_key;
+
+    for (int distance = 3; distance <= end; distance += 2) {
+        // "other" is zero when the opponent's moves since then cancel out
+        other ^= td_history_key(td, distance - 1) ^ td_history_key(td, distance) ^ side_key;
+        if (other != 0) continue;
+
+        U64 move_key = original_key ^ td_history_key(td, distance);
+        int index = cuckoo_h1(move_key);
+        if (cuckoo_keys[index] != move_key) {
+            index = cuckoo_h2(move_key);
+            if (cuckoo_keys[index] != move_key) continue;
+        }
+
+        int move = cuckoo_moves[index];
+        if (squares_between(get_move_source(move), get_move_target(move)) & td.occupancies[both]) continue;
+
+        // Only cycles back to a position inside the search tree are scored as draws
+        if (td.ply > distance) return 1;
+    }
+    return 0;
+}
+
+// Small per-thread offset on quiet move scores: helpers break history ties
+// differently from the main thread and from each other (0 for thread 0 and
+// for the independent searches of root split and batch)
+static inline int td_order_noise(ThreadData& td, int move) {
+    if (!td.thread_id || search_task != task_search) return 0;
+    return (int)((((unsigned)move * 2654435761u) ^ ((unsigned)td.thread_id * 0x9E3779B9u)) >> 28);
+}
+
 // Thread-local move scoring
 static inline int td_score_move(ThreadData& td, int move) {
-    if (get_move_capture(move)) {
+    if (get_move_capture(td.occupancies, td.side, move)) {
         int see_value = td_see(td, move);
         
         if (see_value >= 0) {
-            int piece = get_move_piece(move);
+            int piece = get_move_piece(td.bitboards, td.side, move);
             int target_piece = P;
             int start_piece, end_piece;
             if (td.side == white) { start_piece = p; end_piece = k; }
@@ -497,7 +628,7 @@ static inline int td_score_move(ThreadData& td, int move) {
     else {
         if (td.killer_moves[0][td.ply] == move) return 9000;
         else if (td.killer_moves[1][td.ply] == move) return 8000;
-        else return td.history_moves[get_move_piece(move)][get_move_target(move)];
+        else return td.history_moves[get_move_piece(td.bitboards, td.side, move)][get_move_target(move)] + td_order_noise(td, move);
     }
     return 0;
 }
@@ -521,46 +652,109 @@ static inline void td_sort_moves(ThreadData& td, moves* move_list, int best_move
     }
 }
 
-// Check if search should stop
-static inline bool should_stop(ThreadData& td) {
-    if (stop_threads.load(std::memory_order_relaxed)) return true;
-    
-    // Only check time every 2048 nodes
-    if ((td.nodes & 2047) == 0) {
-        if (timeset && get_time_ms() > stoptime) {
-            stop_threads.store(true, std::memory_order_relaxed);
-            return true;
-        }
+// Remember the best move of an exact-score node
+static inline void td_store_pv(ThreadData& td, int move) {
+    PVEntry& entry = td.pv_hash[td.hash_key & (pv_hash_entries - 1)];
+    entry.lock = (unsigned int)(td.hash_key >> 32);
+    entry.move = move;
+}
+
+// PV move of the current position (0 if none)
+static inline int td_probe_pv(ThreadData& td) {
+    PVEntry& entry = td.pv_hash[td.hash_key & (pv_hash_entries - 1)];
+    return entry.lock == (unsigned int)(td.hash_key >> 32) ? entry.move : 0;
+}
+
+// Rebuild the principal variation by following the PV hash from the root
+static int td_collect_pv(ThreadData& td, int* pv_line) {
+    U64 bb_copy[12], occ_copy[3];
+    memcpy(bb_copy, td.bitboards, 96);
+    memcpy(occ_copy, td.occupancies, 24);
+    int side_c = td.side, ep_c = td.enpassant, castle_c = td.castle, fifty_c = td.fifty;
+    U64 hash_c = td.hash_key;
+
+    U64 keys[max_ply];
+    int length = 0;
+
+    while (length < max_ply) {
+        int move = td_probe_pv(td);
+        if (!move) break;
+
+        // The stored move must be legal here (the index only covers part of the key)
+        moves move_list[1];
+        td_generate_moves<gen_all>(td, move_list);
+        int found = 0;
+        for (int i = 0; i < move_list->count && !found; i++)
+            found = move_list->moves[i] == move;
+        if (!found) break;
+
+        // Stop before the line runs into a repetition
+        int repeated = 0;
+        for (int i = 0; i < length && !repeated; i++)
+            repeated = keys[i] == td.hash_key;
+        if (repeated) break;
+
+        keys[length] = td.hash_key;
+        if (!td_make_move(td, move, all_moves, NULL)) break;
+        pv_line[length++] = move;
     }
-    return false;
+
+    memcpy(td.bitboards, bb_copy, 96);
+    memcpy(td.occupancies, occ_copy, 24);
+    td.side = side_c; td.enpassant = ep_c; td.castle = castle_c;
+    td.fifty = fifty_c; td.hash_key = hash_c;
+    return length;
+}
+
+// Check if search should stop (the deadline is enforced by the timer thread)
+static inline bool should_stop() {
+    return stop_threads.load(std::memory_order_relaxed);
 }
 
 // Quiescence search
 int td_quiescence(ThreadData& td, int alpha, int beta) {
-    if (should_stop(td)) return 0;
+    if (should_stop()) return 0;
     
-    td.nodes++;
+    td_count_node(td);
     
     if (td.ply > max_ply - 1) return td_evaluate(td);
 
-    int evaluation = td_evaluate(td);
+    // TT probe: quiescence results are stored at depth 0, any entry answers
+    int pv_node = beta - alpha > 1;
+    int best_move = 0, tt_eval;
+    tt_bucket* bucket = td_bucket_of(td, td.hash_key);
+    int score = read_hash_entry_mt(bucket, td.hash_key, td.ply, alpha, beta, &best_move, &tt_eval, 0, &td.tt);
+    if (score != no_hash_entry && !pv_node) {
+        tt_count(td.tt.cutoffs);
+        return score;
+    }
+
+    int evaluation = (tt_eval != no_eval) ? tt_eval : td_evaluate(td);
     
-    if (evaluation >= beta) return beta;
+    if (evaluation >= beta) {
+        write_hash_entry_mt(bucket, td.hash_key, td.ply, beta, evaluation, best_move, 0, hash_flag_beta, &td.tt);
+        return beta;
+    }
     
     // Delta pruning
     if (evaluation + 975 < alpha) return alpha;
     
-    if (evaluation > alpha) alpha = evaluation;
+    int hash_flag = hash_flag_alpha;
+    if (evaluation > alpha) {
+        alpha = evaluation;
+        hash_flag = hash_flag_exact;
+    }
 
+    const AttackInfo& info = td_attack_info(td);
     moves move_list[1];
-    td_generate_moves(td, move_list);
-    td_sort_moves(td, move_list, 0);
+    td_generate_moves<gen_captures>(td, move_list);
+    td_sort_moves(td, move_list, best_move);
 
     for (int count = 0; count < move_list->count; count++) {
         int move = move_list->moves[count];
         
         // SEE pruning for bad captures
-        if (get_move_capture(move) && td_see(td, move) < -200)
+        if (get_move_capture(td.occupancies, td.side, move) && td_see(td, move) < -200)
             continue;
         
         // Save state
@@ -576,13 +770,13 @@ int td_quiescence(ThreadData& td, int alpha, int beta) {
         td.repetition_index++;
         td.repetition_table[td.repetition_index] = td.hash_key;
 
-        if (td_make_move(td, move, only_captures) == 0) {
+        if (td_make_move(td, move, only_captures, &info) == 0) {
             td.ply--;
             td.repetition_index--;
             continue;
         }
 
-        int score = -td_quiescence(td, -beta, -alpha);
+        score = -td_quiescence(td, -beta, -alpha);
 
         // Restore state
         td.ply--;
@@ -596,15 +790,46 @@ int td_quiescence(ThreadData& td, int alpha, int beta) {
 
         if (score > alpha) {
             alpha = score;
-            if (score >= beta) return beta;
+            best_move = move;
+            hash_flag = hash_flag_exact;
+            if (score >= beta) {
+                write_hash_entry_mt(bucket, td.hash_key, td.ply, beta, evaluation, best_move, 0, hash_flag_beta, &td.tt);
+                return beta;
+            }
         }
     }
+
+    write_hash_entry_mt(bucket, td.hash_key, td.ply, alpha, evaluation, best_move, 0, hash_flag, &td.tt);
     return alpha;
 }
 
+// ABDADA: tags of (position, move) pairs being searched by some thread.
+// Lossy and lock-free; a wrong answer only changes the move order
+#define abdada_entries 32768
+#define abdada_min_depth 3
+
+static std::atomic<unsigned int> abdada_table[abdada_entries];
+
+static inline U64 abdada_move_hash(U64 key, int move) {
+    return key ^ ((U64)move * 0x9E3779B97F4A7C15ULL);
+}
+
+static inline int abdada_busy(U64 move_hash) {
+    return abdada_table[move_hash & (abdada_entries - 1)].load(std::memory_order_relaxed) == (unsigned int)(move_hash >> 32);
+}
+
+static inline void abdada_start(U64 move_hash) {
+    abdada_table[move_hash & (abdada_entries - 1)].store((unsigned int)(move_hash >> 32), std::memory_order_relaxed);
+}
+
+static inline void abdada_finish(U64 move_hash) {
+    std::atomic<unsigned int>& slot = abdada_table[move_hash & (abdada_entries - 1)];
+    if (slot.load(std::memory_order_relaxed) == (unsigned int)(move_hash >> 32))
+        slot.store(0, std::memory_order_relaxed);
+}
+
 // Main negamax search
 int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
-    td.pv_length[td.ply] = td.ply;
     int score;
     int best_move = 0;
     int hash_flag = hash_flag_alpha;
@@ -612,24 +837,40 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
     // Draw detection
     if (td.ply && (td_is_repetition(td) || td.fifty >= 100)) return 0;
 
+    // Upcoming repetition: a draw is already available to the side to move
+    if (td.ply && alpha < 0 && td_has_game_cycle(td)) {
+        alpha = 0;
+        if (alpha >= beta) return alpha;
+    }
+
+    // Quiescence probes the table itself; probing here too would count twice
+    if (depth == 0) return td_quiescence(td, alpha, beta);
+
     int pv_node = beta - alpha > 1;
 
     // TT probe
-    if (td.ply && (score = read_hash_entry_mt(td.hash_key, td.ply, alpha, beta, &best_move, depth)) != no_hash_entry && !pv_node)
-        return score;
+    int tt_eval = no_eval;
+    tt_bucket* bucket = td_bucket_of(td, td.hash_key);
+    if (td.ply) {
+        score = read_hash_entry_mt(bucket, td.hash_key, td.ply, alpha, beta, &best_move, &tt_eval, depth, &td.tt);
+        if (score != no_hash_entry && !pv_node) {
+            tt_count(td.tt.cutoffs);
+            return score;
+        }
+    }
 
-    if (should_stop(td)) return 0;
+    if (should_stop()) return 0;
 
-    if (depth == 0) return td_quiescence(td, alpha, beta);
     if (td.ply > max_ply - 1) return td_evaluate(td);
 
-    td.nodes++;
+    td_count_node(td);
 
-    int in_check = td_is_square_attacked(td, (td.side == white) ? get_ls1b_index(td.bitboards[K]) : get_ls1b_index(td.bitboards[k]), td.side ^ 1);
+    const AttackInfo& info = td_attack_info(td);
+    int in_check = info.checkers != 0;
     if (in_check) depth++;
 
     int legal_moves = 0;
-    int static_eval = td_evaluate(td);
+    int static_eval = (tt_eval != no_eval) ? tt_eval : td_evaluate(td);
 
     // Evaluation pruning (reverse futility)
     if (depth < 3 && !pv_node && !in_check && abs(beta - 1) > -infinity + 100) {
@@ -649,14 +890,18 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
         side_c = td.side; ep_c = td.enpassant; castle_c = td.castle;
         fifty_c = td.fifty; hash_c = td.hash_key;
 
+        int last_null_ply_c = td.last_null_ply;
+
         td.ply++;
         td.repetition_index++;
         td.repetition_table[td.repetition_index] = td.hash_key;
+        td.last_null_ply = td.ply;
         
         if (td.enpassant != no_sq) td.hash_key ^= enpassant_keys[td.enpassant];
         td.enpassant = no_sq;
         td.side ^= 1;
         td.hash_key ^= side_key;
+        tt_prefetch(td_bucket_of(td, td.hash_key));
 
         // Null move reduction: R = 2 + depth/4
         int R = 2 + depth / 4;
@@ -666,6 +911,7 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
 
         td.ply--;
         td.repetition_index--;
+        td.last_null_ply = last_null_ply_c;
         memcpy(td.bitboards, bb_copy, 96);
         memcpy(td.occupancies, occ_copy, 24);
         td.side = side_c; td.enpassant = ep_c; td.castle = castle_c;
@@ -694,12 +940,30 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
     }
 
     moves move_list[1];
-    td_generate_moves(td, move_list);
+    if (in_check) td_generate_moves<gen_evasions>(td, move_list);
+    else td_generate_moves<gen_all>(td, move_list);
     td_sort_moves(td, move_list, best_move);
 
     int moves_searched = 0;
 
-    for (int count = 0; count < move_list->count; count++) {
+    // ABDADA: moves another thread is searching are put off to the end
+    int abdada = smp_mode == smp_abdada && num_threads > 1 && depth >= abdada_min_depth;
+    U16 deferred[256];
+    int deferred_count = 0;
+
+    for (int count = 0; count < move_list->count + deferred_count; count++) {
+        int is_deferred = count >= move_list->count;
+        int move = is_deferred ? deferred[count - move_list->count] : move_list->moves[count];
+        U64 move_hash = abdada ? abdada_move_hash(td.hash_key, move) : 0;
+
+        if (abdada && moves_searched > 0 && !is_deferred && abdada_busy(move_hash)) {
+            deferred[deferred_count++] = move;
+            continue;
+        }
+
+        int piece = get_move_piece(td.bitboards, td.side, move);
+        int capture = get_move_capture(td.occupancies, td.side, move);
+
         // Save state
         U64 bb_copy[12], occ_copy[3];
         int side_c, ep_c, castle_c, fifty_c;
@@ -713,7 +977,7 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
         td.repetition_index++;
         td.repetition_table[td.repetition_index] = td.hash_key;
 
-        if (td_make_move(td, move_list->moves[count], all_moves) == 0) {
+        if (td_make_move(td, move, all_moves, &info) == 0) {
             td.ply--;
             td.repetition_index--;
             continue;
@@ -721,6 +985,10 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
 
         legal_moves++;
 
+        // Other threads skip this move while we search it (not the first move)
+        int marked = abdada && moves_searched > 0;
+        if (marked) abdada_start(move_hash);
+
         // PVS with LMR
         if (moves_searched == 0) {
             score = -td_negamax(td, -beta, -alpha, depth - 1);
@@ -728,8 +996,7 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
         else {
             // Late Move Reductions
             if (moves_searched >= 4 && depth >= 3 && !in_check &&
-                !get_move_capture(move_list->moves[count]) &&
-                !get_move_promoted(move_list->moves[count])) {
+                !capture && !get_move_promoted(move)) {
                 
                 // Calculate reduction
                 int reduction = 1;
@@ -750,6 +1017,8 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
             }
         }
 
+        if (marked) abdada_finish(move_hash);
+
         // Restore state
         td.ply--;
         td.repetition_index--;
@@ -764,27 +1033,21 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
 
         if (score > alpha) {
             hash_flag = hash_flag_exact;
-            best_move = move_list->moves[count];
+            best_move = move;
 
             // Update history for quiet moves
-            if (!get_move_capture(move_list->moves[count]))
-                td.history_moves[get_move_piece(move_list->moves[count])][get_move_target(move_list->moves[count])] += depth * depth;
+            if (!capture)
+                td.history_moves[piece][get_move_target(move)] += depth * depth;
 
             alpha = score;
 
-            // Update PV
-            td.pv_table[td.ply][td.ply] = move_list->moves[count];
-            for (int next_ply = td.ply + 1; next_ply < td.pv_length[td.ply + 1]; next_ply++)
-                td.pv_table[td.ply][next_ply] = td.pv_table[td.ply + 1][next_ply];
-            td.pv_length[td.ply] = td.pv_length[td.ply + 1];
-
             if (score >= beta) {
-                write_hash_entry_mt(td.hash_key, td.ply, beta, best_move, depth, hash_flag_beta);
+                write_hash_entry_mt(bucket, td.hash_key, td.ply, beta, static_eval, best_move, depth, hash_flag_beta, &td.tt);
                 
                 // Update killers for quiet moves
-                if (!get_move_capture(move_list->moves[count])) {
+                if (!capture) {
                     td.killer_moves[1][td.ply] = td.killer_moves[0][td.ply];
-                    td.killer_moves[0][td.ply] = move_list->moves[count];
+                    td.killer_moves[0][td.ply] = move;
                 }
                 return beta;
             }
@@ -799,48 +1062,92 @@ int td_negamax(ThreadData& td, int alpha, int beta, int depth) {
             return 0;
     }
 
-    write_hash_entry_mt(td.hash_key, td.ply, alpha, best_move, depth, hash_flag);
+    if (hash_flag == hash_flag_exact)
+        td_store_pv(td, best_move);
+
+    write_hash_entry_mt(bucket, td.hash_key, td.ply, alpha, static_eval, best_move, depth, hash_flag, &td.tt);
     return alpha;
 }
 
+// Print a score in UCI form ("cp x" or "mate n")
+static void print_score(int score) {
+    if (score > -mate_value && score < -mate_score)
+        printf("mate %d", -(score + mate_value) / 2 - 1);
+    else if (score > mate_score && score < mate_value)
+        printf("mate %d", (mate_value - score) / 2 + 1);
+    else
+        printf("cp %d", score);
+}
+
 // Print UCI info line
 static void print_info(ThreadData& td, int depth, int score) {
+    if (search_quiet) return;
+
+    int pv_line[max_ply];
+    int pv_length = td_collect_pv(td, pv_line);
+
+    // The PV hash may already hold an unfinished iteration: keep the line
+    // only when it starts with the move of the last completed one
+    if (!pv_length || pv_line[0] != td.best_move) {
+        pv_line[0] = td.best_move;
+        pv_length = 1;
+    }
+
     int elapsed = get_time_ms() - search_start_time;
     U64 nodes_total = get_total_nodes();
     U64 nps = elapsed > 0 ? (nodes_total * 1000) / elapsed : 0;
     
     std::lock_guard<std::mutex> lock(output_mutex);
     
-    if (score > -mate_value && score < -mate_score) {
-        printf("info depth %d score mate %d nodes %llu nps %llu time %d pv ", 
-               depth, -(score + mate_value) / 2 - 1, nodes_total, nps, elapsed);
-    }
-    else if (score > mate_score && score < mate_value) {
-        printf("info depth %d score mate %d nodes %llu nps %llu time %d pv ", 
-               depth, (mate_value - score) / 2 + 1, nodes_total, nps, elapsed);
-    }
-    else {
-        printf("info depth %d score cp %d nodes %llu nps %llu time %d pv ", 
-               depth, score, nodes_total, nps, elapsed);
-    }
+    printf("info depth %d score ", depth);
+    print_score(score);
+    printf(" nodes %llu nps %llu hashfull %d time %d pv ", nodes_total, nps, hashfull(), elapsed);
     
-    for (int i = 0; i < td.pv_length[0]; i++) {
-        print_move(td.pv_table[0][i]);
+    for (int i = 0; i < pv_length; i++) {
+        print_move(pv_line[i]);
         printf(" ");
     }
     printf("\n");
     fflush(stdout);
 }
 
-// Main thread iterative deepening
-static void main_thread_search(int depth) {
-    ThreadData& td = thread_data[0];
-    copy_board_to_thread(td);
+// Sum the hash table counters of all threads into tt_search_stats; the
+// threads may still be counting, each sum is then a recent lower bound
+static void aggregate_tt_stats() {
+    U64 probes = 0, hits = 0, cutoffs = 0, replacements = 0, rejects = 0;
+    for (int i = 0; i < num_threads; i++) {
+        tt_stats& tt = thread_data[i]->tt;
+        probes += tt.probes.load(std::memory_order_relaxed);
+        hits += tt.hits.load(std::memory_order_relaxed);
+        cutoffs += tt.cutoffs.load(std::memory_order_relaxed);
+        replacements += tt.replacements.load(std::memory_order_relaxed);
+        rejects += tt.rejects.load(std::memory_order_relaxed);
+    }
+    tt_search_stats.probes.store(probes, std::memory_order_relaxed);
+    tt_search_stats.hits.store(hits, std::memory_order_relaxed);
+    tt_search_stats.cutoffs.store(cutoffs, std::memory_order_relaxed);
+    tt_search_stats.replacements.store(replacements, std::memory_order_relaxed);
+    tt_search_stats.rejects.store(rejects, std::memory_order_relaxed);
+}
 
+// Lazy SMP skip schedule: helper i skips depth d when (d + phase) / size is odd,
+// so helpers spread over neighbouring depths instead of repeating each other
+static const int skip_size[20]  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static const int skip_phase[20] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+static inline int skip_iteration(int thread_id, int depth) {
+    if (!thread_id || !skip_schedule || smp_mode == smp_abdada) return 0;
+    int i = (thread_id - 1) % 20;
+    return ((depth + skip_phase[i]) / skip_size[i]) % 2;
+}
+
+// Iterative deepening with aspiration windows on the thread's board. In a
+// parallel search thread 0 reports progress and helpers follow the skip
+// schedule; independent (batch) searches do neither
+static void td_iterate(ThreadData& td, int depth, int parallel) {
     memset(td.killer_moves, 0, sizeof(td.killer_moves));
     memset(td.history_moves, 0, sizeof(td.history_moves));
-    memset(td.pv_table, 0, sizeof(td.pv_table));
-    memset(td.pv_length, 0, sizeof(td.pv_length));
+    memset(td.pv_hash, 0, sizeof(td.pv_hash));
 
     int alpha = -infinity;
     int beta = infinity;
@@ -848,6 +1155,8 @@ static void main_thread_search(int depth) {
     for (int current_depth = 1; current_depth <= depth; current_depth++) {
         if (stop_threads.load(std::memory_order_relaxed)) break;
 
+        if (parallel && skip_iteration(td.thread_id, current_depth)) continue;
+
         int score = td_negamax(td, alpha, beta, current_depth);
 
         if (stop_threads.load(std::memory_order_relaxed)) break;
@@ -866,131 +1175,737 @@ static void main_thread_search(int depth) {
         beta = score + 50;
 
         // Update best results
-        if (td.pv_length[0] > 0) {
-            td.best_move = td.pv_table[0][0];
+        int root_move = td_probe_pv(td);
+        if (root_move) {
+            td.best_move = root_move;
             td.best_score = score;
             td.completed_depth = current_depth;
-            
-            // Print info
-            print_info(td, current_depth, score);
+
+            if (parallel && td.thread_id == 0)
+                print_info(td, current_depth, score);
         }
+
+        if (td.thread_id == 0) aggregate_tt_stats();
     }
 }
 
-// Helper thread search (different starting depths for diversity)
-static void helper_thread_search(int thread_id, int depth) {
-    ThreadData& td = thread_data[thread_id];
+// Thread body of a parallel search of the UCI position
+static void iterative_deepening(ThreadData& td, int depth) {
     copy_board_to_thread(td);
+    td_iterate(td, depth, 1);
+}
 
-    memset(td.killer_moves, 0, sizeof(td.killer_moves));
-    memset(td.history_moves, 0, sizeof(td.history_moves));
-    memset(td.pv_table, 0, sizeof(td.pv_table));
-    memset(td.pv_length, 0, sizeof(td.pv_length));
+// Stop all search threads
+void stop_search_threads() {
+    stop_threads.store(true, std::memory_order_relaxed);
+}
 
-    int alpha = -infinity;
-    int beta = infinity;
-    
-    // Start at slightly different depths for search diversity
-    int start_depth = 1 + (thread_id % 3);
-    if (start_depth > depth) start_depth = 1;
+// Helper thread body: park until a search starts, search, report back
+static void worker_loop(int thread_id, int last_search_id) {
+    thread_setup(thread_id);
+
+    while (1) {
+        int depth, task;
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex);
+            pool_wakeup.wait(lock, [&] { return pool_exit || pool_search_id != last_search_id; });
+            if (pool_exit) return;
+            last_search_id = pool_search_id;
+            depth = pool_depth;
+            task = search_task;
+        }
 
-    for (int current_depth = start_depth; current_depth <= depth; current_depth++) {
-        if (stop_threads.load(std::memory_order_relaxed)) break;
+        if (task == task_root_split)
+            root_split_worker(*thread_data[thread_id], depth);
+        else if (task == task_batch)
+            batch_worker(*thread_data[thread_id], depth);
+        else
+            iterative_deepening(*thread_data[thread_id], depth);
 
-        int score = td_negamax(td, alpha, beta, current_depth);
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (--pool_active == 0)
+            pool_finished.notify_all();
+    }
+}
 
-        if (stop_threads.load(std::memory_order_relaxed)) break;
+// Wake the parked helpers for a new search
+void start_search_threads(int depth) {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        pool_depth = depth;
+        pool_active = (int)search_threads.size();
+        pool_search_id++;
+    }
+    pool_wakeup.notify_all();
+}
 
-        if ((score <= alpha) || (score >= beta)) {
-            alpha = -infinity;
-            beta = infinity;
-            current_depth--;
+// Wait for all helpers to finish the current search
+void wait_for_threads() {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    pool_finished.wait(lock, [] { return pool_active == 0; });
+}
+
+// Vote for the final move: every thread backs its best move with a weight of
+// (score - lowest score + 14) * completed depth; the thread whose move
+// collects the most weight wins (thread 0 on ties)
+static int select_best_thread() {
+    int min_score = infinity;
+    for (int i = 0; i < num_threads; i++)
+        if (thread_data[i]->best_move && thread_data[i]->best_score < min_score)
+            min_score = thread_data[i]->best_score;
+
+    long long votes[MAX_THREADS];
+    for (int i = 0; i < num_threads; i++) {
+        votes[i] = 0;
+        if (!thread_data[i]->best_move) continue;
+        for (int j = 0; j < num_threads; j++)
+            if (thread_data[j]->best_move == thread_data[i]->best_move)
+                votes[i] += (long long)(thread_data[j]->best_score - min_score + 14) * thread_data[j]->completed_depth;
+    }
+
+    int best = 0;
+    for (int i = 1; i < num_threads; i++)
+        if (votes[i] > votes[best])
+            best = i;
+    return best;
+}
+
+// Move to play when no iteration finished (a stop right after go): the hash
+// move of the root if it is legal, otherwise the first legal move; 0 only
+// when the side to move has no legal move
+static int fallback_root_move(ThreadData& td) {
+    copy_board_to_thread(td);
+
+    int hash_move = 0, eval;
+    tt_stats stats;
+    tt_clear_stats(&stats);
+    read_hash_entry_mt(td_bucket_of(td, td.hash_key), td.hash_key, 0, -infinity, infinity, &hash_move, &eval, 0, &stats);
+
+    moves move_list[1];
+    td_generate_moves<gen_all>(td, move_list);
+
+    int first_legal = 0;
+    for (int count = 0; count < move_list->count; count++) {
+        int move = move_list->moves[count];
+
+        U64 bb_copy[12], occ_copy[3];
+        memcpy(bb_copy, td.bitboards, 96);
+        memcpy(occ_copy, td.occupancies, 24);
+        int side_c = td.side, ep_c = td.enpassant, castle_c = td.castle, fifty_c = td.fifty;
+        U64 hash_c = td.hash_key;
+
+        if (!td_make_move(td, move, all_moves, NULL)) continue;
+
+        memcpy(td.bitboards, bb_copy, 96);
+        memcpy(td.occupancies, occ_copy, 24);
+        td.side = side_c; td.enpassant = ep_c; td.castle = castle_c;
+        td.fifty = fifty_c; td.hash_key = hash_c;
+
+        if (move == hash_move) return move;
+        if (!first_legal) first_legal = move;
+    }
+
+    return first_legal;
+}
+
+// Driver thread body: run one search per wakeup
+static void driver_loop() {
+    thread_setup(0);
+
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    while (1) {
+        driver_wakeup.wait(lock, [] { return driver_exit || driver_busy; });
+        if (driver_exit) return;
+
+        int depth = driver_depth;
+        int task = search_task;
+        lock.unlock();
+        if (task == task_root_split)
+            root_split_search(depth);
+        else if (task == task_batch)
+            batch_search(depth);
+        else
+            search_position_mt(depth);
+        lock.lock();
+
+        driver_busy = false;
+        driver_idle.notify_all();
+    }
+}
+
+// Hand a task to the driver thread
+static void start_driver(int depth, int task) {
+    wait_for_search();
+
+    // Cleared here rather than in the search so an early "stop" is not lost
+    stop_threads.store(false, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        driver_depth = depth;
+        search_task = task;
+        driver_busy = true;
+    }
+    driver_wakeup.notify_all();
+}
+
+// Start a search in the background, the caller keeps reading input
+void start_search(int depth) {
+    start_driver(depth, task_search);
+}
+
+// Start a root split analysis in the background
+void start_root_split(int depth) {
+    start_driver(depth, task_root_split);
+}
+
+// Wait until the background search has printed its bestmove
+void wait_for_search() {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    driver_idle.wait(lock, [] { return !driver_busy; });
+}
+
+// Timer thread body: wait for a deadline, stop the search when it passes
+static void timer_loop() {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    while (!pool_exit) {
+        if (!timer_armed) {
+            timer_wakeup.wait(lock);
             continue;
         }
 
-        alpha = score - 50;
-        beta = score + 50;
-
-        if (td.pv_length[0] > 0) {
-            td.best_move = td.pv_table[0][0];
-            td.best_score = score;
-            td.completed_depth = current_depth;
+        int remaining = timer_deadline - get_time_ms();
+        if (remaining > 0) {
+            timer_wakeup.wait_for(lock, std::chrono::milliseconds(remaining));
+            continue;
         }
+
+        // Deadline reached
+        stop_threads.store(true, std::memory_order_relaxed);
+        timer_armed = false;
     }
 }
 
-// Stop all search threads
-void stop_search_threads() {
-    stop_threads.store(true, std::memory_order_relaxed);
+// Arm the timer with the deadline of the current search
+static void arm_timer(int deadline) {
+    if (!timer_thread.joinable())
+        timer_thread = std::thread(timer_loop);
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        timer_deadline = deadline;
+        timer_armed = true;
+    }
+    timer_wakeup.notify_all();
 }
 
-// Wait for all threads to finish
-void wait_for_threads() {
-    for (auto& t : search_threads) {
-        if (t.joinable())
-            t.join();
+static void cancel_timer() {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!timer_armed) return;
+        timer_armed = false;
+    }
+    timer_wakeup.notify_all();
+}
+
+// Clear the per-search counters and results of all threads
+static void reset_thread_results() {
+    for (int i = 0; i < num_threads; i++) {
+        thread_data[i]->nodes.store(0, std::memory_order_relaxed);
+        thread_data[i]->best_move = 0;
+        thread_data[i]->best_score = -infinity;
+        thread_data[i]->completed_depth = 0;
     }
-    search_threads.clear();
 }
 
-// Multi-threaded search entry point
+// Multi-threaded search entry point (stop_threads must be cleared by the caller)
 void search_position_mt(int depth) {
     search_start_time = get_time_ms();
     
     // Reset state
-    stop_threads.store(false, std::memory_order_relaxed);
     stopped = 0;
+
+    // Entries of earlier searches become stale but stay usable
+    tt_new_search();
+    reset_thread_results();
     
-    // Initialize all thread data
-    for (int i = 0; i < num_threads; i++) {
-        thread_data[i].nodes = 0;
-        thread_data[i].best_move = 0;
-        thread_data[i].best_score = -infinity;
-        thread_data[i].completed_depth = 0;
-    }
-    
-    // Clear previous threads
-    search_threads.clear();
-    
-    // Start helper threads
-    for (int i = 1; i < num_threads; i++) {
-        search_threads.emplace_back(helper_thread_search, i, depth);
-    }
+    if (timeset)
+        arm_timer(stoptime);
+
+    // Wake the helper threads
+    start_search_threads(depth);
     
     // Main thread does the search (and outputs info)
-    main_thread_search(depth);
+    iterative_deepening(*thread_data[0], depth);
     
     // Stop helpers
     stop_threads.store(true, std::memory_order_relaxed);
     
     // Wait for all helpers
     wait_for_threads();
+    cancel_timer();
+    aggregate_tt_stats();
     
-    // Find best result (prefer main thread, but check if helpers found better)
-    int best_move = thread_data[0].best_move;
-    int best_score = thread_data[0].best_score;
-    int best_depth = thread_data[0].completed_depth;
-    
-    for (int i = 1; i < num_threads; i++) {
-        // Only consider if helper completed same or deeper depth with better score
-        if (thread_data[i].completed_depth >= best_depth && 
-            thread_data[i].best_score > best_score &&
-            thread_data[i].best_move != 0) {
-            best_move = thread_data[i].best_move;
-            best_score = thread_data[i].best_score;
-            best_depth = thread_data[i].completed_depth;
-        }
-    }
+    // Pick the move with the most votes over all threads
+    int best = select_best_thread();
+    int best_move = thread_data[best]->best_move;
+    best_thread_id.store(best, std::memory_order_relaxed);
     
+    if (search_quiet) return;
+
+    if (!best_move)
+        best_move = fallback_root_move(*thread_data[0]);
+
+    // The last info line came from the main thread, repeat the winner's
+    if (best && best_move == thread_data[best]->best_move)
+        print_info(*thread_data[best], thread_data[best]->completed_depth, thread_data[best]->best_score);
+
     // Output best move
+    std::lock_guard<std::mutex> lock(output_mutex);
+    if (num_threads > 1 && thread_data[best]->best_move)
+        printf("info string best thread %d\n", best);
     printf("bestmove ");
-    if (best_move) {
+    if (best_move)
         print_move(best_move);
-    } else if (thread_data[0].pv_table[0][0]) {
-        print_move(thread_data[0].pv_table[0][0]);
-    } else {
+    else
         printf("(none)");
+    printf("\n");
+    fflush(stdout);
+}
+
+// Bench positions: opening, middlegame, endgame
+static const char* bench_positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r2q1rk1/ppp2ppp/2n1bn2/2b1p3/3pP3/3P1NPP/PPP1NPB1/R1BQ1RK1 b - - 0 9",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "2r3k1/R7/8/1R6/8/8/P4KPP/8 w - - 0 40",
+};
+
+// Search the bench positions to a fixed depth with the current thread
+// settings, print nodes and speed and return the time taken in ms
+// (leaves the start position set up)
+int search_bench(int depth) {
+    U64 total = 0;
+    int total_time = 0;
+
+    search_quiet = 1;
+    timeset = 0;
+    for (const char* fen : bench_positions) {
+        if (!hash_shared) clear_hash_table();
+        parse_fen(fen);
+
+        int start = get_time_ms();
+        start_search(depth);
+        wait_for_search();
+        int elapsed = get_time_ms() - start;
+
+        total += get_total_nodes();
+        total_time += elapsed;
     }
+    search_quiet = 0;
+    parse_fen(start_position);
+
+    printf("bench depth %d threads %d bind %s nodes %llu time %d nps %llu\n",
+           depth, num_threads, bind_threads ? "on" : "off", total, total_time,
+           total_time > 0 ? total * 1000 / total_time : 0ULL);
+    fflush(stdout);
+    return total_time;
+}
+
+// Time-to-depth speedup over doubling thread counts, 1 up to max_threads,
+// for Lazy SMP and ABDADA (one thread is the common baseline)
+void search_scaling_bench(int depth, int max_threads) {
+    int saved_threads = num_threads;
+    int saved_mode = smp_mode;
+
+    init_threads(1);
+    int base_time = search_bench(depth);
+
+    for (int mode = smp_lazy; mode <= smp_abdada; mode++) {
+        smp_mode = mode;
+        for (int threads = 2; threads <= max_threads; threads *= 2) {
+            init_threads(threads);
+            int elapsed = search_bench(depth);
+            printf("scaling mode %s threads %d time %d speedup %.2f\n",
+                   mode == smp_abdada ? "abdada" : "lazy", threads, elapsed,
+                   elapsed > 0 ? (double)base_time / elapsed : 0.0);
+            fflush(stdout);
+        }
+    }
+
+    smp_mode = saved_mode;
+    init_threads(saved_threads);
+}
+
+// Root split: the legal root moves form a shared queue; every thread takes
+// the next unsearched move when it finishes one, so fast threads pick up the
+// work of slow ones. The queue is refilled once per depth: every move is
+// searched to depth d before any move is searched to d + 1.
+static U16 split_moves[256];
+static int split_scores[256];       // score of the deepest search of the move
+static int split_prev_scores[256];  // score one depth less
+static int split_depths[256];
+static int split_count = 0;
+static std::atomic<int> split_next(0);
+
+// End of a depth: the threads wait for each other, the last one refills the
+// queue and decides for all of them whether the next depth is searched
+static std::mutex split_mutex;
+static std::condition_variable split_wakeup;
+static int split_waiting = 0;
+static int split_round = 0;
+static bool split_go_on = false;
+
+static bool root_split_barrier() {
+    std::unique_lock<std::mutex> lock(split_mutex);
+    int round = split_round;
+    if (++split_waiting == num_threads) {
+        split_waiting = 0;
+        split_round++;
+        split_go_on = !stop_threads.load(std::memory_order_relaxed);
+        split_next.store(0, std::memory_order_relaxed);
+        split_wakeup.notify_all();
+    } else
+        split_wakeup.wait(lock, [&] { return split_round != round; });
+    return split_go_on;
+}
+
+// Score of a move at a depth it or its next depth has completed
+static int split_score_at(int index, int depth) {
+    return split_depths[index] > depth ? split_prev_scores[index] : split_scores[index];
+}
+
+// Search one root move to the given depth on the child position
+static void root_split_move(ThreadData& td, int index, int depth) {
+    int move = split_moves[index];
+
+    U64 bb_copy[12], occ_copy[3];
+    memcpy(bb_copy, td.bitboards, 96);
+    memcpy(occ_copy, td.occupancies, 24);
+    int side_c = td.side, ep_c = td.enpassant, castle_c = td.castle, fifty_c = td.fifty;
+    U64 hash_c = td.hash_key;
+
+    td.ply++;
+    td.repetition_index++;
+    td.repetition_table[td.repetition_index] = td.hash_key;
+
+    if (td_make_move(td, move, all_moves, NULL)) {
+        int score = -td_negamax(td, -infinity, infinity, depth - 1);
+        if (!stop_threads.load(std::memory_order_relaxed)) {
+            split_prev_scores[index] = split_scores[index];
+            split_scores[index] = score;
+            split_depths[index] = depth;
+        }
+    }
+
+    td.ply--;
+    td.repetition_index--;
+    memcpy(td.bitboards, bb_copy, 96);
+    memcpy(td.occupancies, occ_copy, 24);
+    td.side = side_c; td.enpassant = ep_c; td.castle = castle_c;
+    td.fifty = fifty_c; td.hash_key = hash_c;
+}
+
+// Thread body of a root split: empty the queue once per depth. After a stop
+// the remaining moves return at once, so every thread still reaches the
+// barrier of the depth
+static void root_split_worker(ThreadData& td, int depth) {
+    copy_board_to_thread(td);
+
+    memset(td.killer_moves, 0, sizeof(td.killer_moves));
+    memset(td.history_moves, 0, sizeof(td.history_moves));
+    memset(td.pv_hash, 0, sizeof(td.pv_hash));
+
+    for (int current_depth = 1; current_depth <= depth; current_depth++) {
+        while (1) {
+            int index = split_next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= split_count) break;
+            root_split_move(td, index, current_depth);
+        }
+        if (!root_split_barrier()) break;
+    }
+}
+
+// Score every legal root move to the given depth using all threads, print
+// one multipv line per move (best first) and the best move
+static void root_split_search(int depth) {
+    search_start_time = get_time_ms();
+    stopped = 0;
+    tt_new_search();
+    reset_thread_results();
+
+    // Legal root moves, in move ordering order so the expensive ones start first
+    ThreadData& td = *thread_data[0];
+    copy_board_to_thread(td);
+    memset(td.killer_moves, 0, sizeof(td.killer_moves));
+    memset(td.history_moves, 0, sizeof(td.history_moves));
+
+    moves move_list[1];
+    td_generate_moves<gen_all>(td, move_list);
+    td_sort_moves(td, move_list, 0);
+
+    split_count = 0;
+    for (int count = 0; count < move_list->count; count++) {
+        U64 bb_copy[12], occ_copy[3];
+        memcpy(bb_copy, td.bitboards, 96);
+        memcpy(occ_copy, td.occupancies, 24);
+        int side_c = td.side, ep_c = td.enpassant, castle_c = td.castle, fifty_c = td.fifty;
+        U64 hash_c = td.hash_key;
+
+        if (td_make_move(td, move_list->moves[count], all_moves, NULL)) {
+            split_moves[split_count] = move_list->moves[count];
+            split_scores[split_count] = -infinity;
+            split_prev_scores[split_count] = -infinity;
+            split_depths[split_count] = 0;
+            split_count++;
+
+            memcpy(td.bitboards, bb_copy, 96);
+            memcpy(td.occupancies, occ_copy, 24);
+            td.side = side_c; td.enpassant = ep_c; td.castle = castle_c;
+            td.fifty = fifty_c; td.hash_key = hash_c;
+        }
+    }
+    split_next.store(0, std::memory_order_relaxed);
+
+    if (timeset)
+        arm_timer(stoptime);
+
+    // Every thread, the driver included, works the queue
+    start_search_threads(depth);
+    root_split_worker(td, depth);
+    wait_for_threads();
+    cancel_timer();
+    aggregate_tt_stats();
+
+    // Rank the moves by their scores at the deepest depth all of them
+    // completed; before the first one nothing is ranked
+    int full_depth = split_count ? max_ply : 0;
+    for (int i = 0; i < split_count; i++)
+        if (split_depths[i] < full_depth) full_depth = split_depths[i];
+
+    int order[256];
+    for (int i = 0; i < split_count; i++) order[i] = i;
+    if (full_depth)
+        std::stable_sort(order, order + split_count, [full_depth](int a, int b) {
+            return split_score_at(a, full_depth) > split_score_at(b, full_depth);
+        });
+
+    if (search_quiet) return;
+
+    int elapsed = get_time_ms() - search_start_time;
+    U64 nodes_total = get_total_nodes();
+
+    std::lock_guard<std::mutex> lock(output_mutex);
+    for (int i = 0; full_depth && i < split_count; i++) {
+        int index = order[i];
+        printf("info depth %d multipv %d score ", full_depth, i + 1);
+        print_score(split_score_at(index, full_depth));
+        printf(" nodes %llu time %d pv ", nodes_total, elapsed);
+        print_move(split_moves[index]);
+        printf("\n");
+    }
+
+    printf("bestmove ");
+    if (full_depth)
+        print_move(split_moves[order[0]]);
+    else if (split_count)
+        print_move(fallback_root_move(td));
+    else
+        printf("(none)");
     printf("\n");
     fflush(stdout);
 }
+
+// Batch: independent fixed-depth searches of the positions of an EPD file.
+// Each thread searches one position at a time in its own slice of the hash
+// table and takes the next position from the shared queue when done, so a
+// long search never holds up the others. Results are written as they finish.
+struct BatchPosition {
+    std::string fen;
+    std::string opcodes;    // the record's own operations, "; " terminated
+};
+
+static std::vector<BatchPosition> batch_positions;
+static FILE* batch_output = NULL;
+static std::atomic<int> batch_next(0);
+static std::atomic<U64> batch_nodes(0);
+static std::atomic<int> batch_done(0);
+static std::mutex batch_board_mutex;   // parse_fen works on the global board
+
+static void move_to_string(int move, char* text) {
+    if (get_move_promoted(move))
+        sprintf(text, "%s%s%c", square_to_coordinates[get_move_source(move)],
+                square_to_coordinates[get_move_target(move)], mapPieceToPromotion(get_move_promoted(move)));
+    else
+        sprintf(text, "%s%s", square_to_coordinates[get_move_source(move)],
+                square_to_coordinates[get_move_target(move)]);
+}
+
+// EPD centipawn evaluation: a mate in n plies is written as +-(32767 - n),
+// everything else is kept within that range
+static int epd_score(int score) {
+    if (score > mate_score && score < mate_value) return 32767 - (mate_value - score);
+    if (score > -mate_value && score < -mate_score) return -32767 + (mate_value + score);
+    if (score > 32767) return 32767;
+    if (score < -32767) return -32767;
+    return score;
+}
+
+static void batch_worker(ThreadData& td, int depth) {
+    // own slice of the table, cleared before every position; a shared table
+    // is also used by other engines, so it is neither split nor cleared
+    U64 slice = hash_buckets / num_threads;
+    int partitioned = !hash_shared && slice;
+    if (!partitioned) slice = hash_buckets;
+    tt_bucket* table = partitioned ? hash_table + slice * td.thread_id : hash_table;
+
+    while (!stop_threads.load(std::memory_order_relaxed)) {
+        int index = batch_next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= (int)batch_positions.size()) break;
+        const BatchPosition& position = batch_positions[index];
+
+        if (partitioned) clear_hash_buckets(slice * td.thread_id, slice);
+
+        {
+            std::lock_guard<std::mutex> lock(batch_board_mutex);
+            parse_fen(position.fen.c_str());
+            copy_board_to_thread(td);
+        }
+        td.tt_table = table;
+        td.tt_buckets = slice;
+        td.best_move = 0;
+        td.best_score = -infinity;
+        td.completed_depth = 0;
+
+        int start = get_time_ms();
+        td_iterate(td, depth, 0);
+        if (stop_threads.load(std::memory_order_relaxed)) break;
+
+        U64 nodes = td.nodes.load(std::memory_order_relaxed);
+        batch_nodes.fetch_add(nodes, std::memory_order_relaxed);
+        batch_done.fetch_add(1, std::memory_order_relaxed);
+
+        char move[8] = "none";
+        if (td.best_move) move_to_string(td.best_move, move);
+
+        // EPD: position fields and opcodes, then depth, nodes, time, eval and move
+        std::lock_guard<std::mutex> lock(output_mutex);
+        fprintf(batch_output, "%s %sacd %d; acn %llu; acs %.3f; ce %d; pv %s;\n",
+                position.fen.c_str(), position.opcodes.c_str(), td.completed_depth, nodes,
+                (get_time_ms() - start) / 1000.0, epd_score(td.best_score), move);
+        fflush(batch_output);
+    }
+}
+
+static void batch_search(int depth) {
+    // the workers set up their positions on the global board: keep the UCI one
+    static U64 repetition_table_copy[1000];
+    int repetition_index_copy = repetition_index;
+    memcpy(repetition_table_copy, repetition_table, sizeof(repetition_table));
+    copy_board();
+
+    search_start_time = get_time_ms();
+    stopped = 0;
+    tt_new_search();
+    reset_thread_results();
+    batch_next.store(0, std::memory_order_relaxed);
+    batch_nodes.store(0, std::memory_order_relaxed);
+    batch_done.store(0, std::memory_order_relaxed);
+
+    start_search_threads(depth);
+    batch_worker(*thread_data[0], depth);
+    wait_for_threads();
+    aggregate_tt_stats();
+
+    if (batch_output != stdout) fclose(batch_output);
+    batch_output = NULL;
+    batch_positions.clear();
+
+    take_back();
+    memcpy(repetition_table, repetition_table_copy, sizeof(repetition_table));
+    repetition_index = repetition_index_copy;
+
+    int elapsed = get_time_ms() - search_start_time;
+    U64 nodes = batch_nodes.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(output_mutex);
+    printf("info string batch done positions %d nodes %llu time %d nps %llu\n",
+           batch_done.load(std::memory_order_relaxed), nodes, elapsed,
+           elapsed > 0 ? nodes * 1000 / elapsed : 0ULL);
+    fflush(stdout);
+}
+
+// Operations of an EPD record after its four position fields, without the
+// ones batch writes itself; a record without an id gets its line number
+static std::string batch_opcodes(const char* text, int line_number) {
+    std::string kept;
+    int has_id = 0;
+
+    while (1) {
+        while (*text == ' ' || *text == '\t') text++;
+        if (!*text || *text == '\n' || *text == '\r') break;
+
+        // an operation runs to the next ';' outside a quoted string
+        const char* start = text;
+        int quoted = 0;
+        while (*text && *text != '\n' && *text != '\r' && (quoted || *text != ';')) {
+            if (*text == '"') quoted = !quoted;
+            text++;
+        }
+        std::string operation(start, text - start);
+        if (*text == ';') text++;
+
+        while (!operation.empty() && operation.back() == ' ') operation.pop_back();
+        std::string opcode = operation.substr(0, operation.find(' '));
+        if (opcode == "acd" || opcode == "acn" || opcode == "acs" || opcode == "ce" || opcode == "pv")
+            continue;
+        if (opcode == "id") has_id = 1;
+        kept += operation + "; ";
+    }
+
+    if (!has_id)
+        kept += "id \"" + std::to_string(line_number) + "\"; ";
+    return kept;
+}
+
+// Read an EPD file and search all its positions to depth in the background,
+// writing to out_path or stdout
+int start_batch(const char* epd_path, const char* out_path, int depth) {
+    FILE* file = open_stream(epd_path, "r");
+    if (!file) return 0;
+
+    FILE* output = stdout;
+    if (out_path && *out_path) {
+        output = open_stream(out_path, "w");
+        if (!output) {
+            fclose(file);
+            return 0;
+        }
+    }
+
+    wait_for_search();
+    batch_positions.clear();
+
+    char line[1024];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char board[128], turn[8], castling[8], ep[8];
+        int used = 0;
+        if (sscanf(line, "%127s %7s %7s %7s%n", board, turn, castling, ep, &used) != 4) continue;
+
+        // FEN move counters are not EPD operations
+        int halfmove, fullmove, counters = 0;
+        if (sscanf(line + used, "%d %d%n", &halfmove, &fullmove, &counters) == 2) used += counters;
+
+        BatchPosition position;
+        position.fen = std::string(board) + " " + turn + " " + castling + " " + ep;
+        position.opcodes = batch_opcodes(line + used, line_number);
+        batch_positions.push_back(position);
+    }
+    fclose(file);
+
+    batch_output = output;
+    start_driver(depth, task_batch);
+    return 1;
+}
@@ -4,15 +4,40 @@
 
 #include "defs.h"
 #include "search.h"
+#include "tt_new.h"
 #include <thread>
 #include <vector>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 
 #define MAX_THREADS 64
 
-// Thread-local data structure
-struct ThreadData {
+// Parallel search modes (UCI option SMPMode)
+enum { smp_lazy, smp_abdada };
+
+// Tasks of the driver thread and the pool
+enum { task_search, task_root_split, task_batch };
+
+// PV hash: best moves of exact-score nodes, walked from the root to print the PV
+#define pv_hash_entries 2048
+
+struct PVEntry {
+    unsigned int lock;  // upper 32 bits of the hash key
+    int move;
+};
+
+// Attack information of one node, computed lazily and shared by the in-check
+// test, castling generation, legality after make and SEE
+struct AttackInfo {
+    U64 key;        // hash key of the position this information belongs to
+    U64 attacked;   // squares attacked by the side not to move (seen through our king)
+    U64 checkers;   // enemy pieces giving check
+    U64 pinned;     // our pieces pinned against our king
+};
+
+// Thread-local data structure, cache-line aligned so no two threads share a line
+struct alignas(64) ThreadData {
     int thread_id;
     
     // Board state copy
@@ -27,36 +52,44 @@ struct ThreadData {
     // Repetition detection
     U64 repetition_table[1000];
     int repetition_index;
+    int last_null_ply;
     
     // Search state
     int ply;
-    U64 nodes;
+
+    // Node counter alone on its line: written by the owner, read by others
+    alignas(64) std::atomic<U64> nodes;
+
+    alignas(64) tt_stats tt;
+    tt_bucket* tt_table;    // part of the hash table searched in: all of it,
+    U64 tt_buckets;         // or the thread's own slice during a batch
+    AttackInfo attack_info[max_ply];
     
     // Move ordering
     int killer_moves[2][max_ply];
     int history_moves[12][64];
     
-    // PV table
-    int pv_length[max_ply];
-    int pv_table[max_ply][max_ply];
+    // PV hash (16 KB, stays cache resident)
+    PVEntry pv_hash[pv_hash_entries];
     
     // Results
     int best_move;
     int best_score;
     int completed_depth;
-    
-    // Padding to avoid false sharing (cache line is typically 64 bytes)
-    char padding[64];
 };
 
 // Global thread management
 extern std::vector<std::thread> search_threads;
-extern std::vector<ThreadData> thread_data;
+extern std::vector<ThreadData*> thread_data;
 extern std::atomic<bool> stop_threads;
 extern std::atomic<U64> total_nodes;
-extern std::atomic<int> best_thread_id;  // Track which thread has best result
+extern std::atomic<int> best_thread_id;  // thread whose move won the vote in the last search
 extern std::mutex output_mutex;
 extern int num_threads;
+extern int bind_threads;   // pin threads to NUMA nodes (UCI option BindThreads)
+extern int skip_schedule;  // helpers skip iterations by thread index (UCI option SkipSchedule)
+extern int smp_mode;       // smp_lazy or smp_abdada
+extern int search_quiet;   // suppress info and bestmove output (bench)
 
 // Search start time (for info output)
 extern int search_start_time;
@@ -67,19 +100,45 @@ extern void copy_board_to_thread(ThreadData& td);
 extern void start_search_threads(int depth);
 extern void stop_search_threads();
 extern void wait_for_threads();
+extern void release_threads();
+extern void bind_to_thread_node(int thread_id);
 
 // Thread-local search functions
 extern int td_negamax(ThreadData& td, int alpha, int beta, int depth);
 extern int td_quiescence(ThreadData& td, int alpha, int beta);
 
+// Attack information of the current node (computed on first use)
+extern void td_compute_attack_info(ThreadData& td, AttackInfo& info);
+
+inline const AttackInfo& td_attack_info(ThreadData& td) {
+    AttackInfo& info = td.attack_info[td.ply];
+    if (info.key != td.hash_key) td_compute_attack_info(td, info);
+    return info;
+}
+
 // Multi-threaded search entry point
 extern void search_position_mt(int depth);
 
+// Background search on the driver thread
+extern void start_search(int depth);
+extern void start_root_split(int depth);
+extern int start_batch(const char* epd_path, const char* out_path, int depth);
+extern void wait_for_search();
+
+// Fixed-depth speed test over a few positions, and its thread scaling
+extern int search_bench(int depth);
+extern void search_scaling_bench(int depth, int max_threads);
+
+// Count a node (single writer, so no locked read-modify-write is needed)
+inline void td_count_node(ThreadData& td) {
+    td.nodes.store(td.nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
 // Helper to get total nodes across all threads
 inline U64 get_total_nodes() {
     U64 sum = 0;
     for (int i = 0; i < num_threads; i++) {
-        sum += thread_data[i].nodes;
+        sum += thread_data[i]->nodes.load(std::memory_order_relaxed);
     }
     return sum;
 }
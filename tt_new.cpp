@@ -1,112 +1,584 @@
 #include "tt_new.h"
 #include "defs.h"
 #include "search.h"
+#include "threads_new.h"
+#include "misc.h"
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
+#include <thread>
+#include <vector>
+#include <atomic>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 // Global TT variables
-int hash_entries = 0;
-tt_entry* hash_table = NULL;
+U64 hash_buckets = 0;
+int tt_generation = 0;
+int hash_large_pages = 0;
+int hash_shared = 0;
+tt_bucket* hash_table = NULL;
+tt_stats tt_search_stats;
 
-void init_hash_table(int mb)
+// counters of the single threaded search
+static tt_stats legacy_stats;
+
+// First cache line of a shared segment, the table follows it. The search
+// generation lives here so that all attached processes advance one counter
+typedef struct {
+    std::atomic<int> generation;
+    char padding[64 - sizeof(std::atomic<int>)];
+} tt_shared_header;
+
+// mapping behind a shared table
+static tt_shared_header* hash_shared_header = NULL;
+static size_t hash_shared_size = 0;
+#ifdef _WIN32
+static HANDLE hash_mapping = NULL;
+#endif
+
+// huge page size the table is aligned and rounded to
+#define tt_page_size (2 * 0x100000)
+
+#ifdef _WIN32
+// Large pages need the "Lock pages in memory" privilege (SeLockMemoryPrivilege)
+static void* alloc_large_pages(size_t size)
+{
+    HANDLE token;
+    TOKEN_PRIVILEGES tp;
+    void* memory = NULL;
+    size_t page_size = GetLargePageMinimum();
+
+    if (!page_size || !OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+        return NULL;
+
+    if (LookupPrivilegeValueA(NULL, "SeLockMemoryPrivilege", &tp.Privileges[0].Luid))
+    {
+        tp.PrivilegeCount = 1;
+        tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+        // AdjustTokenPrivileges succeeds without granting when the privilege is missing
+        if (AdjustTokenPrivileges(token, FALSE, &tp, 0, NULL, NULL) && GetLastError() == ERROR_SUCCESS)
+        {
+            size = (size + page_size - 1) & ~(page_size - 1);
+            memory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        }
+    }
+
+    CloseHandle(token);
+    return memory;
+}
+#endif
+
+// Allocate the table 2 MB aligned, on large pages where the OS grants them
+static void* tt_alloc(size_t size)
+{
+#ifdef _WIN32
+    void* memory = alloc_large_pages(size);
+    hash_large_pages = memory != NULL;
+    if (memory == NULL)
+    {
+        size = (size + tt_page_size - 1) & ~(size_t)(tt_page_size - 1);
+        memory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+    return memory;
+#else
+    size = (size + tt_page_size - 1) & ~(size_t)(tt_page_size - 1);
+    void* memory = aligned_alloc(tt_page_size, size);
+    hash_large_pages = 0;
+#ifdef MADV_HUGEPAGE
+    // transparent huge pages are granted on first touch
+    if (memory != NULL)
+        hash_large_pages = madvise(memory, size, MADV_HUGEPAGE) == 0;
+#endif
+    return memory;
+#endif
+}
+
+// Release a table; a shared one is only unmapped, the segment stays for
+// the other processes attached to it
+static void tt_free(void* memory)
 {
-    int hash_size = 0x100000 * mb;
-    hash_entries = hash_size / sizeof(tt_entry);
+#ifdef _WIN32
+    if (hash_shared)
+    {
+        UnmapViewOfFile(hash_shared_header);
+        CloseHandle(hash_mapping);
+        hash_mapping = NULL;
+    }
+    else
+        VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    if (hash_shared)
+        munmap(hash_shared_header, hash_shared_size);
+    else
+        free(memory);
+#endif
+    hash_shared = 0;
+    hash_shared_header = NULL;
+}
+
+// Run work(begin, end) over [0, count) split across the search threads,
+// slice boundaries rounded to a multiple of align. Slice i runs on a thread
+// bound to the node of search thread i, so with BindThreads a table that is
+// first touched here ends up spread over the nodes like the threads are
+template <typename Work>
+static void tt_parallel_for(size_t count, size_t align, Work work)
+{
+    size_t slice = (count / num_threads + align - 1) / align * align;
+    if (slice == 0) slice = align;
+    std::vector<std::thread> workers;
+    int thread_id = 0;
+
+    for (size_t start = 0; start < count; start += slice, thread_id++)
+    {
+        size_t end = (start + slice < count) ? start + slice : count;
+        workers.emplace_back([&work, thread_id, start, end] {
+            bind_to_thread_node(thread_id);
+            work(start, end);
+        });
+    }
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+// Entry of a bucket a position goes to: the one already holding the key,
+// otherwise the empty, shallowest or most stale entry
+static inline tt_entry* tt_replacement_entry(tt_bucket* bucket, U64 key)
+{
+    tt_entry* replace = &bucket->entries[0];
+    int replace_value = 0x7FFFFFFF;
 
-    if (hash_table != NULL)
+    for (int i = 0; i < tt_bucket_entries; i++)
     {
-        free(hash_table);
+        tt_entry* entry = &bucket->entries[i];
+        U64 data = entry->data;
+
+        if ((entry->key ^ data) == key)
+            return entry;
+
+        int value = data ? tt_data_value(data) : -0x7FFFFFFF;
+        if (value < replace_value)
+        {
+            replace_value = value;
+            replace = entry;
+        }
     }
 
-    hash_table = (tt_entry*)malloc(hash_entries * sizeof(tt_entry));
+    return replace;
+}
+
+// Insert the entries of a previous table into the current one in parallel;
+// where several compete for a bucket the most valuable ones survive
+static void tt_rehash(tt_bucket* old_table, U64 old_buckets)
+{
+    tt_parallel_for(old_buckets, 1, [old_table](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; index++)
+        {
+            for (int i = 0; i < tt_bucket_entries; i++)
+            {
+                U64 data = old_table[index].entries[i].data;
+                if (!data) continue;
+
+                U64 key = old_table[index].entries[i].key ^ data;
+                tt_entry* entry = tt_replacement_entry(tt_bucket_of(key), key);
+
+                if (entry->data && tt_data_value(entry->data) > tt_data_value(data))
+                    continue;
+
+                entry->data = data;
+                entry->key = key ^ data;
+            }
+        }
+    });
+}
+
+// (Re)size the table; existing entries are carried over into the new one
+void init_hash_table(U64 mb)
+{
+    size_t hash_size = (size_t)0x100000 * mb;
+    U64 buckets = hash_size / sizeof(tt_bucket);
+
+    tt_bucket* old_table = hash_table;
+    U64 old_buckets = hash_buckets;
+
+    tt_bucket* table = (tt_bucket*)tt_alloc(buckets * sizeof(tt_bucket));
 
-    if (hash_table == NULL)
+    if (table == NULL)
     {
-        // Try with smaller size
+        // Try with smaller size (the current table stays in place meanwhile)
         if (mb > 1)
             init_hash_table(mb / 2);
+        return;
+    }
+
+    hash_table = table;
+    hash_buckets = buckets;
+    clear_hash_table();
+
+    if (old_table != NULL)
+    {
+        tt_rehash(old_table, old_buckets);
+        tt_free(old_table);
+    }
+}
+
+// Move the table into a named shared memory segment (1 on success).
+// The first process creates the segment with the requested size, later ones
+// attach to it with the size it already has; the current entries are
+// inserted into the shared table
+int attach_shared_hash_table(const char* name, U64 mb)
+{
+    // leave a previous segment first (its entries move to a private table)
+    if (hash_shared)
+        init_hash_table(hash_buckets * sizeof(tt_bucket) / 0x100000);
+
+    size_t size = ((size_t)0x100000 * mb + tt_page_size - 1) & ~(size_t)(tt_page_size - 1);
+    void* memory;
+
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, name);
+    if (mapping == NULL)
+        return 0;
+    int created = GetLastError() != ERROR_ALREADY_EXISTS;
+
+    memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (memory == NULL)
+    {
+        CloseHandle(mapping);
+        return 0;
     }
+
+    // an existing mapping keeps its own size
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(memory, &info, sizeof(info));
+    size = info.RegionSize;
+#else
+    char shm_name[256];
+    snprintf(shm_name, sizeof(shm_name), "/%s", name);
+
+    int fd = shm_open(shm_name, O_CREAT | O_RDWR, 0600);
+    if (fd < 0)
+        return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (st.st_size == 0 && ftruncate(fd, size) != 0))
+    {
+        close(fd);
+        return 0;
+    }
+    int created = st.st_size == 0;
+    if (!created)
+        size = st.st_size;
+
+    memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+        return 0;
+#endif
+
+    tt_bucket* old_table = hash_table;
+    U64 old_buckets = hash_buckets;
+
+    // a new segment starts at this process's generation, others join theirs
+    tt_shared_header* header = (tt_shared_header*)memory;
+    if (created)
+        header->generation.store(tt_generation);
     else
+        tt_generation = header->generation.load() & 0x3F;
+
+    hash_table = (tt_bucket*)(header + 1);
+    hash_buckets = size / sizeof(tt_bucket) - 1;
+    hash_large_pages = 0;
+
+    if (old_table != NULL)
     {
-        clear_hash_table();
+        tt_rehash(old_table, old_buckets);
+        tt_free(old_table);
     }
+
+    hash_shared = 1;
+    hash_shared_header = header;
+    hash_shared_size = size;
+#ifdef _WIN32
+    hash_mapping = mapping;
+#endif
+    return 1;
 }
 
 // Clear TT (hash table)
+// The 2 MB aligned slices are zeroed in parallel, each from the node of the
+// search thread with the same index; probes go everywhere in the table, so
+// this only balances the pages over the nodes, it does not make them local
 void clear_hash_table()
 {
     if (hash_table == NULL) return;
-    memset(hash_table, 0, hash_entries * sizeof(tt_entry));
+
+    tt_parallel_for(hash_buckets * sizeof(tt_bucket), tt_page_size, [](size_t begin, size_t end) {
+        memset((char*)hash_table + begin, 0, end - begin);
+    });
+}
+
+// Clear count buckets from first (the slice a batch thread searches in)
+void clear_hash_buckets(U64 first, U64 count)
+{
+    if (hash_table == NULL) return;
+    memset(hash_table + first, 0, count * sizeof(tt_bucket));
+}
+
+// Permille of sampled entries written by the current search (UCI hashfull)
+int hashfull()
+{
+    U64 buckets = (hash_buckets < 250) ? hash_buckets : 250;
+    U64 used = 0;
+
+    for (U64 index = 0; index < buckets; index++)
+    {
+        for (int i = 0; i < tt_bucket_entries; i++)
+        {
+            U64 data = hash_table[index].entries[i].data;
+            if (data && tt_data_generation(data) == tt_generation)
+                used++;
+        }
+    }
+
+    return buckets ? (int)(used * 1000 / (buckets * tt_bucket_entries)) : 0;
+}
+
+// Debug dump: entries of the whole table by stored depth and by age
+void print_hash_occupancy()
+{
+    U64 by_depth[128] = { 0 }, by_age[64] = { 0 }, used = 0;
+
+    for (U64 index = 0; index < hash_buckets; index++)
+    {
+        for (int i = 0; i < tt_bucket_entries; i++)
+        {
+            U64 data = hash_table[index].entries[i].data;
+            if (!data) continue;
+
+            by_depth[tt_data_depth(data)]++;
+            by_age[tt_data_age(data)]++;
+            used++;
+        }
+    }
+
+    U64 entries = hash_buckets * tt_bucket_entries;
+    printf("\n  entries used: %llu of %llu (%.2f%%)\n", used, entries, entries ? 100.0 * used / entries : 0.0);
+
+    printf("\n  depth     entries\n");
+    for (int depth = 0; depth < 128; depth++)
+        if (by_depth[depth])
+            printf("  %5d  %10llu\n", depth, by_depth[depth]);
+
+    printf("\n    age     entries\n");
+    for (int age = 0; age < 64; age++)
+        if (by_age[age])
+            printf("  %5d  %10llu\n", age, by_age[age]);
+
+    printf("\n");
+}
+
+// Hash snapshot file: header followed by the raw buckets
+#define tt_file_magic 0x31485341484D5254ULL  // "TRMHASH1"
+#define tt_file_chunk (64 * 0x100000)
+
+typedef struct {
+    U64 magic;
+    U64 buckets;
+    U64 generation;
+} tt_file_header;
+
+// Stream the table to a file in large sequential writes (1 on success)
+int save_hash_table(const char* path)
+{
+    FILE* file = (hash_table != NULL) ? open_stream(path, "wb") : NULL;
+    if (file == NULL)
+        return 0;
+
+    setvbuf(file, NULL, _IONBF, 0);
+
+    tt_file_header header = { tt_file_magic, hash_buckets, (U64)tt_generation };
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    size_t size = hash_buckets * sizeof(tt_bucket);
+    for (size_t done = 0; ok && done < size; done += tt_file_chunk)
+    {
+        size_t bytes = (size - done < tt_file_chunk) ? size - done : tt_file_chunk;
+        ok = fwrite((char*)hash_table + done, 1, bytes, file) == bytes;
+    }
+
+    return (fclose(file) == 0) && ok;
+}
+
+// Replace the table contents with a snapshot (1 on success); a snapshot of
+// another size is streamed in chunks and rehashed into the current table
+int load_hash_table(const char* path)
+{
+    FILE* file = (hash_table != NULL) ? open_stream(path, "rb") : NULL;
+    if (file == NULL)
+        return 0;
+
+    setvbuf(file, NULL, _IONBF, 0);
+
+    tt_file_header header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != tt_file_magic)
+    {
+        fclose(file);
+        return 0;
+    }
+
+    clear_hash_table();
+    tt_generation = (int)(header.generation & 0x3F);
+    if (hash_shared)
+        hash_shared_header->generation.store(tt_generation);
+
+    int ok = 1;
+    size_t size = header.buckets * sizeof(tt_bucket);
+
+    if (header.buckets == hash_buckets)
+    {
+        for (size_t done = 0; ok && done < size; done += tt_file_chunk)
+        {
+            size_t bytes = (size - done < tt_file_chunk) ? size - done : tt_file_chunk;
+            ok = fread((char*)hash_table + done, 1, bytes, file) == bytes;
+        }
+    }
+    else
+    {
+        tt_bucket* chunk = (tt_bucket*)malloc(tt_file_chunk);
+        ok = chunk != NULL;
+
+        for (size_t done = 0; ok && done < size; done += tt_file_chunk)
+        {
+            size_t bytes = (size - done < tt_file_chunk) ? size - done : tt_file_chunk;
+            ok = fread(chunk, 1, bytes, file) == bytes;
+            if (ok) tt_rehash(chunk, bytes / sizeof(tt_bucket));
+        }
+
+        free(chunk);
+    }
+
+    fclose(file);
+
+    // never keep half a snapshot
+    if (!ok) clear_hash_table();
+    return ok;
+}
+
+// Start a new search generation: older entries are kept for probing but
+// lose their depth advantage in the replacement policy
+void tt_new_search()
+{
+    if (hash_shared)
+        tt_generation = (hash_shared_header->generation.fetch_add(1) + 1) & 0x3F;
+    else
+        tt_generation = (tt_generation + 1) & 0x3F;
 }
 
 // Read hash entry - single threaded version (uses global hash_key and ply)
 int read_hash_entry(int alpha, int beta, int* best_move, int depth)
 {
-    return read_hash_entry_mt(hash_key, ply, alpha, beta, best_move, depth);
+    int eval;
+    return read_hash_entry_mt(tt_bucket_of(hash_key), hash_key, ply, alpha, beta, best_move, &eval, depth, &legacy_stats);
 }
 
 // Write hash entry - single threaded version
 void write_hash_entry(int score, int best_move, int depth, int hash_flag)
 {
-    write_hash_entry_mt(hash_key, ply, score, best_move, depth, hash_flag);
+    write_hash_entry_mt(tt_bucket_of(hash_key), hash_key, ply, score, no_eval, best_move, depth, hash_flag, &legacy_stats);
 }
 
-// Thread-safe read using XOR verification
-int read_hash_entry_mt(U64 key, int current_ply, int alpha, int beta, int* best_move, int depth)
+// Thread-safe read using XOR verification: the whole bucket is searched
+// for the key, eval is set to no_eval when the position is not stored
+int read_hash_entry_mt(tt_bucket* bucket, U64 key, int current_ply, int alpha, int beta, int* best_move, int* eval, int depth, tt_stats* stats)
 {
-    tt_entry* entry = &hash_table[key % hash_entries];
-    
-    // Read both values
-    U64 stored_key = entry->key;
-    U64 data = entry->data;
-    
-    // Verify entry integrity using XOR
-    if ((stored_key ^ data) != key)
+    *eval = no_eval;
+    tt_count(stats->probes);
+
+    // entries of other positions (or torn stores) seen on the way
+    int rejected = 0;
+
+    for (int i = 0; i < tt_bucket_entries; i++)
     {
+        // Read both values
+        U64 stored_key = bucket->entries[i].key;
+        U64 data = bucket->entries[i].data;
+
+        // Verify entry integrity using XOR
+        if ((stored_key ^ data) != key)
+        {
+            if (data) rejected++;
+            continue;
+        }
+
+        tt_count(stats->hits);
+
+        // Always return best move and static evaluation
+        *best_move = tt_data_move(data);
+        *eval = tt_data_eval(data);
+
+        if (tt_data_depth(data) >= depth)
+        {
+            int score = tt_data_score(data);
+            int stored_flag = tt_data_flag(data);
+
+            // Adjust mate scores relative to current ply
+            if (score < -mate_score) score += current_ply;
+            if (score > mate_score) score -= current_ply;
+
+            if (stored_flag == hash_flag_exact)
+                return score;
+
+            if ((stored_flag == hash_flag_alpha) && (score <= alpha))
+                return alpha;
+
+            if ((stored_flag == hash_flag_beta) && (score >= beta))
+                return beta;
+        }
+
         return no_hash_entry;
     }
-    
-    // Unpack data
-    int stored_score, stored_depth, stored_flag, stored_move;
-    tt_unpack_data(data, &stored_score, &stored_depth, &stored_flag, &stored_move);
-    
-    // Always return best move for move ordering
-    *best_move = stored_move;
-    
-    if (stored_depth >= depth)
-    {
-        int score = stored_score;
-        
-        // Adjust mate scores relative to current ply
-        if (score < -mate_score) score += current_ply;
-        if (score > mate_score) score -= current_ply;
-        
-        if (stored_flag == hash_flag_exact)
-            return score;
-        
-        if ((stored_flag == hash_flag_alpha) && (score <= alpha))
-            return alpha;
-        
-        if ((stored_flag == hash_flag_beta) && (score >= beta))
-            return beta;
-    }
-    
+
+    tt_count(stats->rejects, rejected);
     return no_hash_entry;
 }
 
 // Thread-safe write using XOR technique
-void write_hash_entry_mt(U64 key, int current_ply, int score, int best_move, int depth, int hash_flag)
+// An entry of the same position is updated in place (a deeper result of the
+// current search survives unless the new one is exact), otherwise the entry
+// with the lowest depth minus age penalty in the bucket is replaced
+void write_hash_entry_mt(tt_bucket* bucket, U64 key, int current_ply, int score, int eval, int best_move, int depth, int hash_flag, tt_stats* stats)
 {
-    tt_entry* entry = &hash_table[key % hash_entries];
-    
+    tt_entry* entry = tt_replacement_entry(bucket, key);
+    U64 old_data = entry->data;
+
+    if ((entry->key ^ old_data) == key)
+    {
+        if (hash_flag != hash_flag_exact && depth + 4 <= tt_data_depth(old_data) && !tt_data_age(old_data))
+            return;
+
+        // keep the known best move of the position
+        if (!best_move) best_move = tt_data_move(old_data);
+    }
+    else if (old_data)
+        tt_count(stats->replacements);
+
     // Adjust mate scores for storage
     int stored_score = score;
     if (stored_score < -mate_score) stored_score -= current_ply;
     if (stored_score > mate_score) stored_score += current_ply;
-    
+
     // Pack data
-    U64 data = tt_pack_data(stored_score, depth, hash_flag, best_move);
-    
+    U64 data = tt_pack_data(stored_score, eval, depth, hash_flag, best_move, tt_generation);
+
     // Store with XOR for verification
     entry->data = data;
     entry->key = key ^ data;
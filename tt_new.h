@@ -4,51 +4,144 @@
 
 #include "defs.h"
 #include <atomic>
+#include <xmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// number of hash table buckets
+extern U64 hash_buckets;
+
+// table is backed by large pages
+extern int hash_large_pages;
+
+// table lives in a named shared memory segment
+extern int hash_shared;
 
-// number hash table entries
-extern int hash_entries;
+// current search generation (6 bits, ages entries of earlier searches)
+extern int tt_generation;
 
 // no hash entry found constant
 #define no_hash_entry 100000
 
+// no static evaluation stored
+#define no_eval 32767
+
 // transposition table hash flags
 #define hash_flag_exact 0
 #define hash_flag_alpha 1
 #define hash_flag_beta 2
 
+// entries per bucket (one 64 byte cache line)
+#define tt_bucket_entries 4
+
 // Lockless transposition table entry
 // Uses XOR technique to detect torn reads/writes
 typedef struct {
     U64 key;        // hash_key XOR data (for verification)
-    U64 data;       // packed: score(16) | depth(8) | flag(8) | best_move(32)
+    U64 data;       // packed: generation(6) | flag(2) | depth(7) | eval(16) | score(17) | best_move(16)
 } tt_entry;
 
+// Bucket of entries sharing one cache line, probed together
+typedef struct {
+    tt_entry entries[tt_bucket_entries];
+} tt_bucket;
+
 // define TT instance
-extern tt_entry* hash_table;
-
-// Pack/unpack functions
-inline U64 tt_pack_data(int score, int depth, int flag, int best_move) {
-    return ((U64)(score + 32768) << 48) | 
-           ((U64)(depth & 0xFF) << 40) | 
-           ((U64)(flag & 0xFF) << 32) | 
-           ((U64)(best_move & 0xFFFFFFFF));
+extern tt_bucket* hash_table;
+
+// Pack/unpack functions (best move is stored in its compact 16-bit form,
+// the score field is wide enough for mate scores)
+inline U64 tt_pack_data(int score, int eval, int depth, int flag, int best_move, int generation) {
+    return ((U64)(generation & 0x3F) << 58) |
+           ((U64)(flag & 0x3) << 56) |
+           ((U64)(depth & 0x7F) << 49) |
+           ((U64)((eval + 32768) & 0xFFFF) << 33) |
+           ((U64)((score + 65536) & 0x1FFFF) << 16) |
+           ((U64)(best_move & 0xFFFF));
+}
+
+#define tt_data_generation(data) ((int)((data) >> 58))
+#define tt_data_flag(data) ((int)(((data) >> 56) & 0x3))
+#define tt_data_depth(data) ((int)(((data) >> 49) & 0x7F))
+#define tt_data_eval(data) ((int)(((data) >> 33) & 0xFFFF) - 32768)
+#define tt_data_score(data) ((int)(((data) >> 16) & 0x1FFFF) - 65536)
+#define tt_data_move(data) ((int)((data) & 0xFFFF))
+
+// generations another process on a shared table may be ahead of this one
+#define tt_max_lead 8
+
+// age of an entry in searches (wraps with the 6-bit generation); an entry
+// written by a process that has already started a newer search counts as current
+inline int tt_data_age(U64 data) {
+    int age = ((tt_generation - tt_data_generation(data) + tt_max_lead) & 0x3F) - tt_max_lead;
+    return (age > 0) ? age : 0;
+}
+
+// worth of an entry for replacement: deep and fresh entries are kept
+#define tt_data_value(data) (tt_data_depth(data) - 8 * tt_data_age(data))
+
+// bucket index of a key: high half of key * buckets, uniform over any
+// table size without a division
+inline U64 tt_index(U64 key, U64 buckets) {
+#ifdef _MSC_VER
+    return __umulh(key, buckets);
+#else
+    return (U64)(((unsigned __int128)key * buckets) >> 64);
+#endif
+}
+
+inline tt_bucket* tt_bucket_of(U64 key) {
+    return &hash_table[tt_index(key, hash_buckets)];
+}
+
+// fetch a bucket into cache ahead of its probe
+inline void tt_prefetch(tt_bucket* bucket) {
+    _mm_prefetch((const char*)bucket, _MM_HINT_T0);
+}
+
+// hash table counters of one search thread; relaxed atomics so thread 0
+// and the uci thread can read them while the owner keeps counting
+typedef struct {
+    std::atomic<U64> probes;        // lookups
+    std::atomic<U64> hits;          // lookups finding the position
+    std::atomic<U64> cutoffs;       // hits whose score ended the node
+    std::atomic<U64> replacements;  // stores overwriting another position
+    std::atomic<U64> rejects;       // occupied entries failing the key check in missed lookups
+} tt_stats;
+
+// counters of all threads, summed after each iteration of the main thread
+// and once the search threads have stopped
+extern tt_stats tt_search_stats;
+
+// Count an event (single writer, so no locked read-modify-write is needed)
+inline void tt_count(std::atomic<U64>& counter, U64 n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
 }
 
-inline void tt_unpack_data(U64 data, int* score, int* depth, int* flag, int* best_move) {
-    *score = (int)((data >> 48) & 0xFFFF) - 32768;
-    *depth = (int)((data >> 40) & 0xFF);
-    *flag = (int)((data >> 32) & 0xFF);
-    *best_move = (int)(data & 0xFFFFFFFF);
+inline void tt_clear_stats(tt_stats* stats) {
+    stats->probes.store(0, std::memory_order_relaxed);
+    stats->hits.store(0, std::memory_order_relaxed);
+    stats->cutoffs.store(0, std::memory_order_relaxed);
+    stats->replacements.store(0, std::memory_order_relaxed);
+    stats->rejects.store(0, std::memory_order_relaxed);
 }
 
 // PROTOTYPES
-extern void init_hash_table(int mb);
+extern void init_hash_table(U64 mb);
 extern int read_hash_entry(int alpha, int beta, int* best_move, int depth);
 extern void write_hash_entry(int score, int best_move, int depth, int hash_flag);
 extern void clear_hash_table();
+extern void tt_new_search();
+extern void clear_hash_buckets(U64 first, U64 count);
+extern int save_hash_table(const char* path);
+extern int load_hash_table(const char* path);
+extern int attach_shared_hash_table(const char* name, U64 mb);
+extern int hashfull();
+extern void print_hash_occupancy();
 
 // Thread-safe versions for multi-threaded search
-extern int read_hash_entry_mt(U64 key, int ply, int alpha, int beta, int* best_move, int depth);
-extern void write_hash_entry_mt(U64 key, int ply, int score, int best_move, int depth, int hash_flag);
+extern int read_hash_entry_mt(tt_bucket* bucket, U64 key, int ply, int alpha, int beta, int* best_move, int* eval, int depth, tt_stats* stats);
+extern void write_hash_entry_mt(tt_bucket* bucket, U64 key, int ply, int score, int eval, int best_move, int depth, int hash_flag, tt_stats* stats);
 
 #endif
@@ -8,10 +8,11 @@
 #include "uci.h"
 #include "movegen.h"
 #include "search.h"
-#include "tt.h"
+#include "tt_new.h"
 #include "misc.h"
 #include "io.h"
-#include "threads.h"
+#include "threads_new.h"
+#include "perft.h"
 #include <thread>
 #include <string.h>
 
@@ -166,8 +167,11 @@ void parse_go(char* command)
     if (depth == -1)
         depth = 64;
 
-    // Start search
-    search_position_mt(depth);
+    // Start search in the background ("go rootsplit" scores every root move)
+    if (strstr(command, "rootsplit"))
+        start_root_split(depth);
+    else
+        start_search(depth);
 }
 
 // main UCI loop - fully compliant with UCI protocol
@@ -177,7 +181,7 @@ void uci_loop()
     static char input[10000];
     
     // Engine settings
-    int max_hash = 1024;
+    int max_hash = 33554432;  // 32 TB
     int mb = 64;
     
     // Detect available threads
@@ -186,15 +190,7 @@ void uci_loop()
     if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
     
     // Initialize with 1 thread (silent)
-    num_threads = 1;
-    thread_data.resize(num_threads);
-    for (int i = 0; i < num_threads; i++) {
-        thread_data[i].thread_id = i;
-        memset(thread_data[i].killer_moves, 0, sizeof(thread_data[i].killer_moves));
-        memset(thread_data[i].history_moves, 0, sizeof(thread_data[i].history_moves));
-        memset(thread_data[i].pv_table, 0, sizeof(thread_data[i].pv_table));
-        memset(thread_data[i].pv_length, 0, sizeof(thread_data[i].pv_length));
-    }
+    init_threads(1);
 
     // Disable I/O buffering for UCI compliance
     setvbuf(stdin, NULL, _IONBF, 0);
@@ -206,8 +202,13 @@ void uci_loop()
         memset(input, 0, sizeof(input));
         fflush(stdout);
 
+        // End of input: finish the running search, then leave like "quit"
         if (!fgets(input, sizeof(input), stdin))
-            continue;
+        {
+            wait_for_search();
+            release_threads();
+            break;
+        }
 
         if (input[0] == '\n')
             continue;
@@ -217,13 +218,22 @@ void uci_loop()
         if (len > 0 && input[len-1] == '\n')
             input[len-1] = '\0';
 
+        // Only stop, isready and quit are served while a search is running
+        if (strncmp(input, "stop", 4) != 0 && strncmp(input, "isready", 7) != 0 && strncmp(input, "quit", 4) != 0)
+            wait_for_search();
+
         // UCI command: "uci"
-        if (strncmp(input, "uci", 3) == 0)
+        if (strcmp(input, "uci") == 0)
         {
             printf("id name %s %s\n", NAME, VERSION);
             printf("id author %s\n", AUTHOR);
             printf("option name Hash type spin default 64 min 1 max %d\n", max_hash);
             printf("option name Threads type spin default 1 min 1 max %d\n", max_threads);
+            printf("option name HashFile type string default <empty>\n");
+            printf("option name SharedHash type string default <empty>\n");
+            printf("option name BindThreads type check default false\n");
+            printf("option name SkipSchedule type check default true\n");
+            printf("option name SMPMode type combo default LazySMP var LazySMP var ABDADA\n");
             printf("uciok\n");
             fflush(stdout);
         }
@@ -231,6 +241,7 @@ void uci_loop()
         // UCI command: "isready"
         else if (strncmp(input, "isready", 7) == 0)
         {
+            std::lock_guard<std::mutex> lock(output_mutex);
             printf("readyok\n");
             fflush(stdout);
         }
@@ -239,14 +250,16 @@ void uci_loop()
         else if (strncmp(input, "ucinewgame", 10) == 0)
         {
             parse_fen(start_position);
-            clear_hash_table();
+
+            // a shared table also serves other engine processes
+            if (!hash_shared)
+                clear_hash_table();
         }
 
         // UCI command: "position"
         else if (strncmp(input, "position", 8) == 0)
         {
             parse_position(input);
-            clear_hash_table();
         }
 
         // UCI command: "go"
@@ -266,7 +279,7 @@ void uci_loop()
         else if (strncmp(input, "quit", 4) == 0)
         {
             stop_search_threads();
-            wait_for_threads();
+            release_threads();
             break;
         }
 
@@ -276,7 +289,29 @@ void uci_loop()
             mb = atoi(input + 26);
             if (mb < 1) mb = 1;
             if (mb > max_hash) mb = max_hash;
-            init_hash_table(mb);
+
+            // a shared table keeps the size of its segment
+            if (!hash_shared)
+                init_hash_table(mb);
+        }
+
+        // UCI command: "setoption name HashFile value X" - load a saved table
+        else if (strncmp(input, "setoption name HashFile value ", 30) == 0)
+        {
+            if (strcmp(input + 30, "<empty>") != 0 && !load_hash_table(input + 30))
+                printf("info string could not load hash file %s\n", input + 30);
+        }
+
+        // UCI command: "setoption name SharedHash value X" - use a named shared memory table
+        else if (strncmp(input, "setoption name SharedHash value ", 32) == 0)
+        {
+            if (strcmp(input + 32, "<empty>") == 0)
+            {
+                if (hash_shared)
+                    init_hash_table(mb);
+            }
+            else if (!attach_shared_hash_table(input + 32, mb))
+                printf("info string could not attach shared hash %s\n", input + 32);
         }
 
         // UCI command: "setoption name Threads value X"
@@ -286,16 +321,27 @@ void uci_loop()
             if (threads < 1) threads = 1;
             if (threads > max_threads) threads = max_threads;
             
-            // Silent thread initialization for UCI compliance
-            num_threads = threads;
-            thread_data.resize(num_threads);
-            for (int i = 0; i < num_threads; i++) {
-                thread_data[i].thread_id = i;
-                memset(thread_data[i].killer_moves, 0, sizeof(thread_data[i].killer_moves));
-                memset(thread_data[i].history_moves, 0, sizeof(thread_data[i].history_moves));
-                memset(thread_data[i].pv_table, 0, sizeof(thread_data[i].pv_table));
-                memset(thread_data[i].pv_length, 0, sizeof(thread_data[i].pv_length));
-            }
+            // Silent thread initialization for UCI compliance (restarts the pool)
+            init_threads(threads);
+        }
+
+        // UCI command: "setoption name BindThreads value true|false" - pin threads to NUMA nodes
+        else if (strncmp(input, "setoption name BindThreads value ", 33) == 0)
+        {
+            bind_threads = strcmp(input + 33, "true") == 0;
+            init_threads(num_threads);
+        }
+
+        // UCI command: "setoption name SkipSchedule value true|false" - helpers skip iterations
+        else if (strncmp(input, "setoption name SkipSchedule value ", 34) == 0)
+        {
+            skip_schedule = strcmp(input + 34, "true") == 0;
+        }
+
+        // UCI command: "setoption name SMPMode value LazySMP|ABDADA" - parallel search mode
+        else if (strncmp(input, "setoption name SMPMode value ", 29) == 0)
+        {
+            smp_mode = strcmp(input + 29, "ABDADA") == 0 ? smp_abdada : smp_lazy;
         }
 
         // Debug command: "d" - print board (non-UCI, but useful)
@@ -303,5 +349,73 @@ void uci_loop()
         {
             print_board();
         }
+
+        // Debug command: "perftsuite" - verify move generator against reference counts
+        else if (strncmp(input, "perftsuite", 10) == 0)
+        {
+            perft_suite();
+        }
+
+        // Command: "savehash <file>" - write the hash table to disk
+        else if (strncmp(input, "savehash ", 9) == 0)
+        {
+            if (save_hash_table(input + 9))
+                printf("info string hash saved to %s\n", input + 9);
+            else
+                printf("info string could not save hash to %s\n", input + 9);
+        }
+
+        // Command: "loadhash <file>" - replace the hash table with a saved one
+        else if (strncmp(input, "loadhash ", 9) == 0)
+        {
+            if (load_hash_table(input + 9))
+                printf("info string hash loaded from %s\n", input + 9);
+            else
+                printf("info string could not load hash from %s\n", input + 9);
+        }
+
+        // Command: "batch <epdfile> <depth> [outfile]" - search every position of an EPD file
+        else if (strncmp(input, "batch ", 6) == 0)
+        {
+            char epd_path[1024], out_path[1024] = "";
+            int depth = 0;
+            if (sscanf(input + 6, "%1023s %d %1023s", epd_path, &depth, out_path) < 2 || depth < 1)
+                printf("info string usage: batch <epdfile> <depth> [outfile]\n");
+            else if (!start_batch(epd_path, out_path, depth))
+                printf("info string could not open %s\n", epd_path);
+        }
+
+        // Command: "smpbench [depth]" - time-to-depth speedup of both modes from 1 to all threads
+        else if (strncmp(input, "smpbench", 8) == 0)
+        {
+            int depth = atoi(input + 8);
+            search_scaling_bench(depth > 0 ? depth : 10, max_threads);
+        }
+
+        // Command: "bench [depth]" - fixed-depth nodes per second test
+        else if (strncmp(input, "bench", 5) == 0)
+        {
+            int depth = atoi(input + 5);
+            search_bench(depth > 0 ? depth : 10);
+        }
+
+        // Debug command: "ttstats" - hash table counters of the last search and page type
+        else if (strncmp(input, "ttstats", 7) == 0)
+        {
+            U64 probes = tt_search_stats.probes.load(std::memory_order_relaxed);
+            U64 hits = tt_search_stats.hits.load(std::memory_order_relaxed);
+            printf("tt probes %llu hits %llu (%.2f%%) cutoffs %llu replacements %llu rejects %llu large pages %s\n",
+                probes, hits, probes ? 100.0 * hits / probes : 0.0,
+                tt_search_stats.cutoffs.load(std::memory_order_relaxed),
+                tt_search_stats.replacements.load(std::memory_order_relaxed),
+                tt_search_stats.rejects.load(std::memory_order_relaxed), hash_large_pages ? "yes" : "no");
+            fflush(stdout);
+        }
+
+        // Debug command: "hashinfo" - hash table occupancy by depth and age
+        else if (strncmp(input, "hashinfo", 8) == 0)
+        {
+            print_hash_occupancy();
+        }
     }
 }
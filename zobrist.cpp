@@ -1,5 +1,11 @@
 #include "defs.h"
 #include "magic.h"
+#include "attacks.h"
+#include "movegen.h"
+#include <algorithm>
+
+U64 cuckoo_keys[cuckoo_size];
+U16 cuckoo_moves[cuckoo_size];
 
 void init_random_keys()
 {
@@ -46,3 +52,52 @@ U64 generate_hash_key()
 
     return final_key;
 }
+
+// fill cuckoo tables with the key difference of every reversible (non pawn) move
+void init_cuckoo()
+{
+    memset(cuckoo_keys, 0, sizeof(cuckoo_keys));
+    memset(cuckoo_moves, 0, sizeof(cuckoo_moves));
+
+    for (int piece = N; piece <= k; piece++)
+    {
+        if (piece == p)
+            continue;
+
+        for (int source_square = 0; source_square < 64; source_square++)
+        {
+            U64 attacks;
+
+            switch (piece % 6)
+            {
+            case N: attacks = knight_attacks[source_square]; break;
+            case B: attacks = get_bishop_attacks(source_square, 0ULL); break;
+            case R: attacks = get_rook_attacks(source_square, 0ULL); break;
+            case Q: attacks = get_queen_attacks(source_square, 0ULL); break;
+            default: attacks = king_attacks[source_square]; break;
+            }
+
+            for (int target_square = source_square + 1; target_square < 64; target_square++)
+            {
+                if (!get_bit(attacks, target_square))
+                    continue;
+
+                U16 move = encode_move(source_square, target_square, 0, move_normal);
+                U64 key = piece_keys[piece][source_square] ^ piece_keys[piece][target_square] ^ side_key;
+                int index = cuckoo_h1(key);
+
+                // cuckoo insertion: evict the occupant to its alternative slot until a free one is found
+                while (1)
+                {
+                    std::swap(cuckoo_keys[index], key);
+                    std::swap(cuckoo_moves[index], move);
+
+                    if (move == 0)
+                        break;
+
+                    index = (index == cuckoo_h1(key)) ? cuckoo_h2(key) : cuckoo_h1(key);
+                }
+            }
+        }
+    }
+}